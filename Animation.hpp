@@ -0,0 +1,804 @@
+#ifndef __ANIMATION_HPP__
+#define __ANIMATION_HPP__
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include <LittleFS.h>
+#include <memory>
+#include <new>
+
+#include "config.h"
+#include "Light.hpp"
+
+#define ANIM_MAGIC 0x4D494E41 // "ANIM", 小端序
+#define ANIM_VERSION 1
+
+enum AnimFormat {
+    ANIM_RGB,         // 每帧为 ledCount 个 RGB 三元组
+    ANIM_RLE,         // 每帧行程编码, 像素为 RGB 三元组
+    ANIM_PALETTE_RLE, // 每帧行程编码, 像素为调色板序号, 调色板紧跟文件头
+    ANIM_FORMAT_COUNT
+};
+
+// 压缩帧的首字节
+enum AnimFrameType {
+    ANIM_KEYFRAME, // 不依赖上一帧
+    ANIM_DELTA,    // 只编码与上一帧不同的像素
+};
+
+// 压缩帧的行程标记, 低位为长度减一
+#define ANIM_LITERAL 0x00 // 0x00-0x7F: 其后为 n 个像素
+#define ANIM_REPEAT  0x80 // 0x80-0xBF: 其后的 1 个像素重复 n 次
+#define ANIM_SKIP    0xC0 // 0xC0-0xFF: n 个像素与上一帧相同
+
+static_assert(sizeof(CRGB) == 3, "Binary animation frames are read directly into CRGB!");
+
+/**
+ * @brief Header of a binary animation file, little-endian
+ *
+ * Uncompressed frames of frameSize() bytes follow the header back to back,
+ * so a frame is loaded with a single read straight into the LED buffer.
+ * Compressed frames vary in size and are decoded by AnimDecoder. pack_anim.py
+ * converts CSV animations into either format.
+ */
+struct __attribute__((packed)) AnimHeader {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t format;
+    uint16_t fps;        // 帧率, 0 为每次刷新播放一帧
+    uint16_t ledCount;   // 每帧灯珠数
+    uint16_t paletteSize; // 调色板颜色数, 仅 ANIM_PALETTE_RLE 使用
+    uint32_t frameCount;  // 总帧数
+
+    bool valid() const {
+        return magic == ANIM_MAGIC && version == ANIM_VERSION && format < ANIM_FORMAT_COUNT && ledCount > 0 &&
+               paletteSize <= (format == ANIM_PALETTE_RLE ? 256 : 0);
+    }
+
+    bool compressed() const {
+        return format != ANIM_RGB;
+    }
+
+    // 首帧在文件中的位置
+    uint32_t dataOffset() const {
+        return sizeof(AnimHeader) + paletteSize * sizeof(CRGB);
+    }
+
+    uint32_t frameSize() const {
+        return ledCount * sizeof(CRGB);
+    }
+
+    // 未压缩时第 frame 帧在文件中的位置
+    uint32_t frameOffset(uint32_t frame) const {
+        return sizeof(AnimHeader) + frame * frameSize();
+    }
+};
+
+static_assert(sizeof(AnimHeader) == 16, "AnimHeader size mismatch!");
+
+#define ANIM_INDEX_MAGIC 0x58444E49 // "INDX", 小端序
+
+/**
+ * @brief Trailer of the keyframe index at the end of a compressed animation
+ *
+ * The index is count uint32_t file offsets of the keyframes interval frames
+ * apart from frame 0, stored right before this trailer. Entries are read one
+ * at a time when seeking, so the index costs no RAM.
+ */
+struct __attribute__((packed)) AnimIndexTrailer {
+    uint32_t magic;
+    uint16_t interval; // 关键帧间隔
+    uint16_t reserved;
+    uint32_t count;    // 关键帧数
+};
+
+static_assert(sizeof(AnimIndexTrailer) == 12, "AnimIndexTrailer size mismatch!");
+
+/**
+ * @brief Read the header of a binary animation
+ *
+ * @param file animation file at position 0
+ * @param header header to fill
+ * @return true if the file is a binary animation, otherwise the position is restored
+ */
+inline bool read_anim_header(File &file, AnimHeader &header) {
+    if (file.read((uint8_t *) &header, sizeof(header)) == sizeof(header) && header.valid()) {
+        return true;
+    }
+    header.magic = 0;
+    file.seek(0);
+    return false;
+}
+
+/**
+ * @brief Read the frame at the current position into the LEDs
+ *
+ * LEDs beyond the frame are left unchanged and pixels beyond the LEDs are
+ * skipped.
+ *
+ * @param file animation file positioned at a frame
+ * @param header header of the animation
+ * @param leds LEDs to fill
+ * @param count number of LEDs
+ * @return true if a whole frame is read
+ */
+inline bool read_anim_frame(File &file, const AnimHeader &header, CRGB *leds, int count) {
+    uint32_t size = std::min<uint32_t>(header.ledCount, count) * sizeof(CRGB);
+    if (file.read((uint8_t *) leds, size) != size) {
+        return false;
+    }
+    if (size < header.frameSize()) {
+        return file.seek(header.frameSize() - size, SeekCur);
+    }
+    return true;
+}
+
+// 压缩格式的灯珠经由一小块 CRGB 缓冲读入
+template <typename Format>
+bool read_anim_frame(File &file, const AnimHeader &header, PackedPixels<Format> leds, int count) {
+    CRGB chunk[16];
+    int n = std::min<int>(header.ledCount, count);
+    for (int i = 0; i < n; i += 16) {
+        int m = std::min(16, n - i);
+        if (file.read((uint8_t *) chunk, m * sizeof(CRGB)) != m * sizeof(CRGB)) {
+            return false;
+        }
+        copy_pixels(leds + i, chunk, m);
+    }
+    if (n < header.ledCount) {
+        return file.seek(header.frameSize() - n * sizeof(CRGB), SeekCur);
+    }
+    return true;
+}
+
+/**
+ * @brief Incremental decoder of compressed frames
+ *
+ * The file is read through a small fixed buffer and runs are expanded
+ * straight into the LEDs, which must still hold the previous frame when a
+ * delta frame is decoded. Decoding resumes at any keyframe listed in the
+ * index through seek(), without the index only at the first frame.
+ */
+class AnimDecoder {
+private:
+    AnimHeader header;
+    std::unique_ptr<CRGB[]> palette;
+    uint32_t indexOffset; // 关键帧索引在文件中的位置
+    uint32_t keyframes;   // 索引中的关键帧数, 0 为没有索引
+    uint16_t interval;    // 关键帧间隔
+    uint8_t pos;
+    uint8_t len;
+    uint8_t buffer[64];
+
+    int next(File &file) {
+        if (pos == len) {
+            pos = 0;
+            len = file.read(buffer, sizeof(buffer));
+            if (len == 0) {
+                return -1;
+            }
+        }
+        return buffer[pos++];
+    }
+
+    bool pixel(File &file, CRGB &color) {
+        if (header.format == ANIM_PALETTE_RLE) {
+            int index = next(file);
+            if (index < 0) {
+                return false;
+            }
+            color = index < header.paletteSize ? palette[index] : CRGB(CRGB::Black);
+            return true;
+        }
+        int r = next(file), g = next(file), b = next(file);
+        color = CRGB(r, g, b);
+        return b >= 0;
+    }
+
+public:
+    AnimDecoder() : indexOffset(0), keyframes(0), interval(0), pos(0), len(0) {}
+
+    /**
+     * @brief Load the palette and locate the keyframe index
+     *
+     * @param file animation file positioned after the header
+     * @param header header of the animation
+     * @return true if the palette is read, the file is then at the first frame
+     */
+    bool begin(File &file, const AnimHeader &header) {
+        this->header = header;
+        reset();
+        if (header.paletteSize > 0) {
+            palette.reset(new CRGB[header.paletteSize]);
+            uint32_t size = header.paletteSize * sizeof(CRGB);
+            if (file.read((uint8_t *) palette.get(), size) != size) {
+                return false;
+            }
+        }
+        keyframes = 0;
+        AnimIndexTrailer trailer;
+        uint32_t size = file.size();
+        if (size >= header.dataOffset() + sizeof(trailer) && file.seek(size - sizeof(trailer)) &&
+            file.read((uint8_t *) &trailer, sizeof(trailer)) == sizeof(trailer) &&
+            trailer.magic == ANIM_INDEX_MAGIC && trailer.interval > 0 && trailer.count > 0 &&
+            trailer.count <= (size - header.dataOffset() - sizeof(trailer)) / sizeof(uint32_t)) {
+            keyframes = trailer.count;
+            interval = trailer.interval;
+            indexOffset = size - sizeof(trailer) - keyframes * sizeof(uint32_t);
+        }
+        return file.seek(header.dataOffset());
+    }
+
+    // 不晚于 frame 的最近关键帧, 没有索引时为首帧
+    uint32_t keyframeBefore(uint32_t frame) const {
+        return keyframes > 0 ? std::min(frame / interval, keyframes - 1) * interval : 0;
+    }
+
+    /**
+     * @brief Move the file to a keyframe, with at most two small reads
+     *
+     * @param file animation file
+     * @param keyframe frame returned by keyframeBefore()
+     * @return true if the file is at the keyframe
+     */
+    bool seek(File &file, uint32_t keyframe) {
+        uint32_t offset = header.dataOffset();
+        if (keyframe > 0 && (!file.seek(indexOffset + keyframe / interval * sizeof(uint32_t)) ||
+                             file.read((uint8_t *) &offset, sizeof(offset)) != sizeof(offset))) {
+            return false;
+        }
+        reset();
+        return file.seek(offset);
+    }
+
+    // 丢弃缓冲的数据, 在移动文件位置后调用
+    void reset() {
+        pos = len = 0;
+    }
+
+    /**
+     * @brief Decode the next frame into the LEDs
+     *
+     * @param file animation file
+     * @param leds LEDs holding the previous frame, CRGB * or PackedPixels
+     * @param count number of LEDs, pixels beyond are skipped
+     * @return true if a whole frame is decoded
+     */
+    template <typename Pixels>
+    bool decode(File &file, Pixels leds, int count) {
+        if (next(file) < 0) { // 帧类型, 关键帧中不会出现 ANIM_SKIP
+            return false;
+        }
+        CRGB color;
+        for (int i = 0; i < header.ledCount;) {
+            int c = next(file);
+            if (c < 0) {
+                return false;
+            }
+            int n = (c & (c < ANIM_REPEAT ? 0x7F : 0x3F)) + 1;
+            if (i + n > header.ledCount) {
+                return false;
+            }
+            if (c < ANIM_REPEAT) {
+                for (int end = i + n; i < end; i++) {
+                    if (!pixel(file, color)) {
+                        return false;
+                    }
+                    if (i < count) {
+                        leds[i] = color;
+                    }
+                }
+            } else if (c < ANIM_SKIP) {
+                if (!pixel(file, color)) {
+                    return false;
+                }
+                if (i < count) {
+                    fill_solid(leds + i, std::min(n, count - i), color);
+                }
+                i += n;
+            } else {
+                i += n;
+            }
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief Playback of a binary animation with a read-ahead ring
+ *
+ * The play head moves through the loop range in either direction. Frames
+ * that come next are loaded into a ring by poll(), called from loop()
+ * between two refreshes, so the render path only copies a frame that is
+ * already in memory, and a flash stall delays the ring rather than the
+ * frame. When the ring does not have the frame the render path loads it
+ * itself and counts an underrun. Without enough heap for the ring, every
+ * frame is loaded at render time.
+ */
+class AnimPlayer {
+    static_assert(ANIM_PREFETCH_FRAMES <= UINT8_MAX, "ANIM_PREFETCH_FRAMES out of range!");
+
+private:
+    File file;
+    AnimHeader header;
+    std::unique_ptr<AnimDecoder> decoder; // 压缩动画的解码器
+    uint32_t fileFrame;    // 文件当前位于第 fileFrame 帧
+    uint32_t currentFrame; // 下一次播放的帧
+    uint32_t rangeStart;   // 循环播放 [rangeStart, rangeEnd) 内的帧
+    uint32_t rangeEnd;     // 0 为到最后一帧
+    bool backward;         // 倒放
+
+    std::unique_ptr<CRGB[]> ring; // 预读的帧, 每帧 header.ledCount 个像素
+    uint32_t ringFrames[ANIM_PREFETCH_FRAMES > 0 ? ANIM_PREFETCH_FRAMES : 1]; // 每个位置上的帧序号
+    uint8_t capacity;      // 可预读的帧数, 0 为不预读
+    uint8_t head;          // 最早预读的帧所在位置
+    uint8_t depth;         // 已预读的帧数
+    uint8_t lastSlot;      // 最近一次解码的位置, 压缩帧在此基础上解码
+    bool stalled;          // 预读失败, 等待播放时重试
+
+    AnimPlayer *next;
+    static AnimPlayer *first; // 所有播放中的动画, 由 pollAll 预读
+
+    // 循环播放的范围 [first, last), 无效时为整个动画
+    void loopRange(uint32_t &first, uint32_t &last) const {
+        last = rangeEnd > 0 && rangeEnd <= header.frameCount ? rangeEnd : header.frameCount;
+        first = rangeStart < last ? rangeStart : 0;
+    }
+
+    uint32_t following(uint32_t frame, uint32_t first, uint32_t last) const {
+        if (backward) {
+            return frame == first ? last - 1 : frame - 1;
+        }
+        return frame + 1 == last ? first : frame + 1;
+    }
+
+    CRGB* slot(int i) {
+        return ring.get() + i * header.ledCount;
+    }
+
+    /**
+     * @brief Load any frame
+     *
+     * Uncompressed frames are at fixed offsets and loaded with one block
+     * read. Compressed frames are decoded from the nearest keyframe before
+     * them, or from the current position if no keyframe lies in between,
+     * so leds must hold the last decoded frame.
+     */
+    template <typename Pixels>
+    bool load(uint32_t frame, Pixels leds, int count) {
+        if (!decoder) {
+            if (frame != fileFrame && !file.seek(header.frameOffset(frame))) {
+                return false;
+            }
+            fileFrame = frame;
+            if (!read_anim_frame(file, header, leds, count)) {
+                return false;
+            }
+            fileFrame++;
+            return true;
+        }
+        uint32_t keyframe = decoder->keyframeBefore(frame);
+        if (frame < fileFrame || keyframe > fileFrame) {
+            if (!decoder->seek(file, keyframe)) {
+                return false;
+            }
+            fileFrame = keyframe;
+        }
+        while (fileFrame <= frame) {
+            if (!decoder->decode(file, leds, count)) {
+                return false;
+            }
+            fileFrame++;
+        }
+        return true;
+    }
+
+    // 预读下一帧到环形缓冲区
+    bool fill() {
+        if (depth == capacity || header.frameCount == 0) {
+            return false;
+        }
+        uint32_t first, last;
+        loopRange(first, last);
+        uint32_t frame;
+        if (depth > 0) {
+            frame = following(ringFrames[(head + depth - 1) % capacity], first, last);
+        } else {
+            frame = currentFrame >= first && currentFrame < last ? currentFrame : backward ? last - 1 : first;
+        }
+        uint8_t i = (head + depth) % capacity;
+        if (decoder && i != lastSlot) {
+            memcpy(slot(i), slot(lastSlot), header.frameSize());
+        }
+        lastSlot = i;
+        if (!load(frame, slot(i), header.ledCount)) {
+            rewind();
+            stalled = true;
+            return false;
+        }
+        ringFrames[i] = frame;
+        depth++;
+        return true;
+    }
+
+    void rewind() {
+        file.seek(header.dataOffset());
+        if (decoder) {
+            decoder->reset();
+        }
+        fileFrame = 0;
+    }
+
+    // 播放顺序改变, 丢弃预读的帧
+    void discard() {
+        depth = 0;
+        stalled = false;
+    }
+
+public:
+    static uint32_t underruns; // 播放时所需的帧尚未预读的次数
+
+    AnimPlayer(File file, const AnimHeader &header) :
+        file(file), header(header), fileFrame(0), currentFrame(0), rangeStart(0), rangeEnd(0), backward(false),
+        capacity(0), head(0), depth(0), lastSlot(0), stalled(false), next(first) {
+        first = this;
+    }
+
+    AnimPlayer(const AnimPlayer &) = delete;
+    AnimPlayer& operator=(const AnimPlayer &) = delete;
+
+    ~AnimPlayer() {
+        for (AnimPlayer **p = &first; *p; p = &(*p)->next) {
+            if (*p == this) {
+                *p = next;
+                break;
+            }
+        }
+    }
+
+    /**
+     * @brief Load the palette and index, and allocate the ring
+     *
+     * The ring holds up to ANIM_PREFETCH_FRAMES frames, as many as fit in
+     * the largest free heap block minus ANIM_PREFETCH_HEAP_RESERVE. Fewer
+     * than 2 frames would never be ahead of the render path, so the ring is
+     * then left out.
+     *
+     * @return true if the animation can be played
+     */
+    bool begin() {
+        if (header.compressed()) {
+            decoder.reset(new AnimDecoder());
+            if (!decoder->begin(file, header)) {
+                return false;
+            }
+        }
+        uint32_t heap = ESP.getMaxFreeBlockSize();
+        uint32_t frames = heap > ANIM_PREFETCH_HEAP_RESERVE ? (heap - ANIM_PREFETCH_HEAP_RESERVE) / header.frameSize() : 0;
+        capacity = std::min<uint32_t>(frames, ANIM_PREFETCH_FRAMES);
+        if (capacity >= 2) {
+            ring.reset(new (std::nothrow) CRGB[capacity * header.ledCount]);
+        }
+        if (!ring) {
+            capacity = 0;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Advance the play head and copy the frame into the LEDs
+     *
+     * @param steps number of frames to advance, frames in between are skipped
+     * @param leds LEDs to fill, CRGB * or PackedPixels, must keep the frame until the next call when there is no ring
+     * @param count number of LEDs
+     * @return true if the frame is loaded, otherwise playback restarts from the first frame
+     */
+    template <typename Pixels>
+    bool play(uint32_t steps, Pixels leds, int count) {
+        if (header.frameCount == 0) {
+            return false;
+        }
+        uint32_t first, last;
+        loopRange(first, last);
+        uint32_t length = last - first;
+        uint32_t skip = (steps - 1) % length;
+        uint32_t frame = currentFrame < first || currentFrame >= last ? (backward ? last - 1 : first) : currentFrame;
+        frame = first + (backward ? frame - first + length - skip : frame - first + skip) % length;
+        bool success;
+        if (capacity > 0) {
+            while (depth > 0 && ringFrames[head] != frame) { // 丢弃跳过的帧
+                head = (head + 1) % capacity;
+                depth--;
+            }
+            if (depth == 0) {
+                underruns++;
+                currentFrame = frame;
+                stalled = false;
+                fill();
+            }
+            success = depth > 0;
+            if (success) {
+                copy_pixels(leds, slot(head), std::min<int>(header.ledCount, count));
+                head = (head + 1) % capacity;
+                depth--;
+            }
+        } else {
+            success = load(frame, leds, count);
+        }
+        if (!success) {
+            rewind();
+            discard();
+            currentFrame = 0;
+            return false;
+        }
+        currentFrame = following(frame, first, last);
+        return true;
+    }
+
+    /**
+     * @brief Jump to a frame
+     *
+     * @param frame frame to play next
+     * @return true if the frame exists
+     */
+    bool seek(uint32_t frame) {
+        if (frame >= header.frameCount) {
+            return false;
+        }
+        currentFrame = frame;
+        discard();
+        return true;
+    }
+
+    /**
+     * @brief Loop over part of the animation
+     *
+     * @param start first frame of the loop
+     * @param end frame after the loop, 0 for the end of the animation
+     */
+    void setLoop(uint32_t start, uint32_t end) {
+        rangeStart = start;
+        rangeEnd = end;
+        discard();
+    }
+
+    void setReverse(bool reverse) {
+        backward = reverse;
+        discard();
+    }
+
+    uint32_t frame() const {
+        return currentFrame;
+    }
+
+    uint32_t frameCount() const {
+        return header.frameCount;
+    }
+
+    uint16_t fps() const {
+        return header.fps;
+    }
+
+    uint32_t loopStart() const {
+        return rangeStart;
+    }
+
+    uint32_t loopEnd() const {
+        return rangeEnd;
+    }
+
+    bool reverse() const {
+        return backward;
+    }
+
+    // 在空闲时为每个播放中的动画预读一帧
+    static void pollAll() {
+        for (AnimPlayer *p = first; p; p = p->next) {
+            if (!p->stalled) {
+                p->fill();
+            }
+        }
+    }
+
+    /**
+     * @brief Add up the ring usage of all playing animations
+     *
+     * @param depth number of frames loaded ahead
+     * @param capacity number of frames the rings can hold
+     */
+    static void stats(uint32_t &depth, uint32_t &capacity) {
+        depth = capacity = 0;
+        for (AnimPlayer *p = first; p; p = p->next) {
+            depth += p->depth;
+            capacity += p->capacity;
+        }
+    }
+};
+
+/**
+ * @brief Streaming converter from CSV animations to the binary format
+ *
+ * Text may arrive in chunks of any size, e.g. from an HTTP upload. Only the
+ * current element and a few pixels are kept in memory, so the RAM used does
+ * not depend on the size of the file. Every row must have exactly ledCount
+ * elements of the form #RRGGBB, the first malformed row stops the conversion
+ * with its line number in error().
+ */
+class AnimTranscoder {
+private:
+    File file;
+    AnimHeader header;
+    uint32_t line;          // 当前行号, 从 1 开始
+    uint16_t index;         // 当前行已解析的元素数
+    uint8_t elementLen;
+    char element[8];        // 当前元素, 最长 7 个字符
+    uint8_t pending;        // buffer 中待写入的字节数
+    uint8_t buffer[48];     // 合并若干像素后再写入文件
+    char errorMessage[64];
+
+    static int hexValue(char c) {
+        return c >= '0' && c <= '9' ? c - '0' :
+               c >= 'A' && c <= 'F' ? c - 'A' + 10 :
+               c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+    }
+
+    bool flush() {
+        if (pending > 0 && file.write(buffer, pending) != pending) {
+            snprintf_P(errorMessage, sizeof(errorMessage), PSTR("Write failed at line %u"), line);
+            return false;
+        }
+        pending = 0;
+        return true;
+    }
+
+    bool parseElement() {
+        element[elementLen] = '\0';
+        if (elementLen != 7 || element[0] != '#') {
+            snprintf_P(errorMessage, sizeof(errorMessage), PSTR("Line %u: invalid element \"%s\""), line, element);
+            return false;
+        }
+        if (index >= header.ledCount) {
+            snprintf_P(errorMessage, sizeof(errorMessage), PSTR("Line %u: more than %u LEDs"), line,
+                       header.ledCount);
+            return false;
+        }
+        for (int i = 1; i < 7; i += 2) {
+            int high = hexValue(element[i]), low = hexValue(element[i + 1]);
+            if (high < 0 || low < 0) {
+                snprintf_P(errorMessage, sizeof(errorMessage), PSTR("Line %u: invalid element \"%s\""), line,
+                           element);
+                return false;
+            }
+            buffer[pending++] = high << 4 | low;
+        }
+        index++;
+        elementLen = 0;
+        return (size_t) pending + 3 <= sizeof(buffer) || flush();
+    }
+
+    bool endLine() {
+        if (index == 0 && elementLen == 0) { // 忽略空行
+            line++;
+            return true;
+        }
+        if (!parseElement()) {
+            return false;
+        }
+        if (index != header.ledCount) {
+            snprintf_P(errorMessage, sizeof(errorMessage), PSTR("Line %u: %u LEDs, expected %u"), line, index,
+                       header.ledCount);
+            return false;
+        }
+        header.frameCount++;
+        line++;
+        index = 0;
+        return true;
+    }
+
+public:
+    AnimTranscoder() {
+        errorMessage[0] = '\0';
+    }
+
+    /**
+     * @brief Start a conversion
+     *
+     * @param file output file opened for writing
+     * @param ledCount number of elements every row must have
+     * @param fps frame rate written to the header, 0 for one frame per refresh
+     * @return true if the header placeholder is written
+     */
+    bool begin(File file, uint16_t ledCount, uint16_t fps) {
+        this->file = file;
+        header.magic = ANIM_MAGIC;
+        header.version = ANIM_VERSION;
+        header.format = ANIM_RGB;
+        header.fps = fps;
+        header.ledCount = ledCount;
+        header.paletteSize = 0;
+        header.frameCount = 0;
+        line = 1;
+        index = 0;
+        elementLen = 0;
+        pending = 0;
+        errorMessage[0] = '\0';
+        if (!file || file.write((const uint8_t *) &header, sizeof(header)) != sizeof(header)) {
+            strcpy_P(errorMessage, PSTR("Open output failed"));
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Convert the next chunk of text
+     *
+     * @param data chunk of the CSV file
+     * @param size size of the chunk
+     * @return true if no error so far
+     */
+    bool write(const uint8_t *data, size_t size) {
+        if (failed()) {
+            return false;
+        }
+        for (size_t i = 0; i < size; i++) {
+            char c = data[i];
+            if (c == ',') {
+                if (!parseElement()) {
+                    return false;
+                }
+            } else if (c == '\n') {
+                if (!endLine()) {
+                    return false;
+                }
+            } else if (c == '\r' || c == ' ' || c == '\t') {
+                continue;
+            } else if (elementLen < sizeof(element) - 1) {
+                element[elementLen++] = c;
+            } else {
+                element[elementLen] = '\0';
+                snprintf_P(errorMessage, sizeof(errorMessage), PSTR("Line %u: invalid element \"%s...\""), line,
+                           element);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Finish the last row and write the frame count into the header
+     *
+     * @return true if the whole file is converted
+     */
+    bool end() {
+        bool success = !failed() && ((index == 0 && elementLen == 0) || endLine()) && flush();
+        if (success && header.frameCount == 0) {
+            strcpy_P(errorMessage, PSTR("No frames"));
+            success = false;
+        }
+        if (success) {
+            file.seek(0);
+            success = file.write((const uint8_t *) &header, sizeof(header)) == sizeof(header);
+        }
+        file.close();
+        return success;
+    }
+
+    // 出错时关闭文件, 由调用者删除
+    void abort() {
+        file.close();
+    }
+
+    bool failed() const {
+        return errorMessage[0] != '\0';
+    }
+
+    const char* error() const {
+        return errorMessage;
+    }
+
+    uint32_t frames() const {
+        return header.frameCount;
+    }
+};
+
+#endif // __ANIMATION_HPP__
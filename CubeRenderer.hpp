@@ -0,0 +1,305 @@
+#ifndef __CUBERENDERER_HPP__
+#define __CUBERENDERER_HPP__
+
+#include <Arduino.h>
+#include <FastLED.h>
+
+#include "Light.hpp"
+
+// 平面的法线方向
+enum CubeAxis {
+    AXIS_X, // x 为常数的平面
+    AXIS_Y, // y 为常数的平面
+    AXIS_Z, // z 为常数的平面, 即一层
+};
+
+/**
+ * @brief Voxel bitmap stored in PROGMEM
+ *
+ * Bit (x, y, z) is bit (x + (y + z * h) * w) of bits, least significant bit
+ * first.
+ */
+struct VoxelSprite {
+    uint8_t w;
+    uint8_t h;
+    uint8_t d;
+    const uint8_t *bits;
+
+    bool test(int x, int y, int z) const {
+        int i = x + (y + z * h) * w;
+        return pgm_read_byte(bits + i / 8) & (1 << (i % 8));
+    }
+};
+
+// RGB565 格式, 每个灯珠 2 字节
+struct Rgb565 {
+    typedef CRGB color_type;
+    typedef uint16_t pixel_type;
+
+    pixel_type encode(CRGB color) const {
+        return (color.r & 0xF8) << 8 | (color.g & 0xFC) << 3 | color.b >> 3;
+    }
+
+    pixel_type pack(CRGB color) const {
+        return encode(color);
+    }
+
+    CRGB decode(pixel_type pixel) const {
+        uint8_t r = pixel >> 11;
+        uint8_t g = (pixel >> 5) & 0x3F;
+        uint8_t b = pixel & 0x1F;
+        return CRGB(r << 3 | r >> 2, g << 2 | g >> 4, b << 3 | b >> 2);
+    }
+};
+
+// 调色板格式, 每个灯珠 1 字节, 颜色为调色板中的序号, 默认调色板为 RGB332
+struct Palette8 {
+    typedef uint8_t color_type;
+    typedef uint8_t pixel_type;
+
+    CRGB palette[256];
+
+    Palette8() {
+        for (int i = 0; i < 256; i++) {
+            palette[i] = CRGB((i >> 5) * 255 / 7, ((i >> 2) & 7) * 255 / 7, (i & 3) * 255 / 3);
+        }
+    }
+
+    pixel_type encode(uint8_t index) const {
+        return index;
+    }
+
+    /**
+     * @brief Find the palette entry nearest to a color
+     *
+     * Effects fill whole slices with one color, so the last match is cached.
+     */
+    pixel_type pack(CRGB color) const {
+        static CRGB lastColor;
+        static pixel_type lastPixel = 0;
+        static const Palette8 *lastPalette = nullptr;
+        if (lastPalette == this && lastColor == color && palette[lastPixel] == color) {
+            return lastPixel;
+        }
+        int best = 0;
+        int bestDistance = 3 * 256 * 256;
+        for (int i = 0; i < 256 && bestDistance > 0; i++) {
+            int dr = palette[i].r - color.r, dg = palette[i].g - color.g, db = palette[i].b - color.b;
+            int distance = dr * dr + dg * dg + db * db;
+            if (distance < bestDistance) {
+                best = i;
+                bestDistance = distance;
+            }
+        }
+        lastColor = color;
+        lastPixel = best;
+        lastPalette = this;
+        return best;
+    }
+
+    CRGB decode(pixel_type pixel) const {
+        return palette[pixel];
+    }
+};
+
+/**
+ * @brief Cube rendering into a compact pixel format
+ *
+ * A light like LightCube whose render buffer is packed: data() returns
+ * PackedPixels, so effects, layers and transitions draw into it as usual, and
+ * DoubleBuffer::swap() expands it into the CRGB front buffer. At 16x16x16 a
+ * CRGB frame takes 12 KB, RGB565 8 KB and Palette8 4 KB, the 768 byte palette
+ * being shared by every frame of the type.
+ *
+ * @tparam Format Rgb565 or Palette8
+ */
+template <int X_COUNT, int Y_COUNT, int Z_COUNT, typename Format>
+class PackedCube {
+public:
+    typedef typename Format::color_type color_type;
+    typedef PackedPixels<Format> pixels_type;
+
+    static constexpr int count() {
+        return X_COUNT * Y_COUNT * Z_COUNT;
+    }
+
+    static Format format;
+
+private:
+    typename Format::pixel_type pixels[count()];
+
+public:
+    PackedCube() {
+        memset(pixels, 0, sizeof(pixels));
+    }
+
+    pixels_type data() {
+        return pixels_type(pixels, &format);
+    }
+
+    constexpr int l() const {
+        return X_COUNT;
+    }
+
+    constexpr int w() const {
+        return Y_COUNT;
+    }
+
+    constexpr int h() const {
+        return Z_COUNT;
+    }
+
+    typename pixels_type::Ref at(int x, int y, int z) {
+        return data()[z * X_COUNT * Y_COUNT + y * X_COUNT + x];
+    }
+
+    void set(int x, int y, int z, color_type color) {
+        pixels[z * X_COUNT * Y_COUNT + y * X_COUNT + x] = format.encode(color);
+    }
+
+    CRGB get(int x, int y, int z) const {
+        return format.decode(pixels[z * X_COUNT * Y_COUNT + y * X_COUNT + x]);
+    }
+
+    void clear() {
+        memset(pixels, 0, sizeof(pixels));
+    }
+
+    static constexpr int slices() {
+        return Z_COUNT;
+    }
+
+    void fillSlice(int slice, CRGB color) {
+        fill_solid(data() + slice * X_COUNT * Y_COUNT, X_COUNT * Y_COUNT, color);
+    }
+
+    /**
+     * @brief Compute every LED from its coordinate
+     *
+     * @param f function from LightPoint to color
+     */
+    template <typename F>
+    void shadePixels(F f) {
+        typename Format::pixel_type *pixel = pixels;
+        for (int z = 0; z < Z_COUNT; z++) {
+            uint8_t pz = Axis<Z_COUNT>::get(z);
+            for (int y = 0; y < Y_COUNT; y++) {
+                uint8_t py = Axis<Y_COUNT>::get(y);
+                for (int x = 0; x < X_COUNT; x++) {
+                    *pixel++ = format.pack(f(LightPoint{(uint8_t) Axis<X_COUNT>::get(x), py, pz}));
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Convert to CRGB, in the same layout as LightCube
+     *
+     * @param out CRGB array of count() LEDs
+     */
+    void expand(CRGB *out) {
+        copy_pixels(out, data(), count());
+    }
+};
+
+template <int X_COUNT, int Y_COUNT, int Z_COUNT, typename Format>
+Format PackedCube<X_COUNT, Y_COUNT, Z_COUNT, Format>::format;
+
+// 以下绘制函数适用于 LightCube 和 PackedCube
+
+/**
+ * @brief Fill a plane perpendicular to an axis
+ *
+ * @param cube cube to draw on
+ * @param axis normal of the plane
+ * @param index coordinate of the plane along the axis
+ * @param color color to fill
+ */
+template <typename Cube>
+void fillPlane(Cube &cube, CubeAxis axis, int index, typename Cube::color_type color) {
+    int n1 = axis == AXIS_X ? cube.w() : cube.l();
+    int n2 = axis == AXIS_Z ? cube.w() : cube.h();
+    for (int j = 0; j < n2; j++) {
+        for (int i = 0; i < n1; i++) {
+            switch (axis) {
+                case AXIS_X:
+                    cube.set(index, i, j, color);
+                    break;
+                case AXIS_Y:
+                    cube.set(i, index, j, color);
+                    break;
+                case AXIS_Z:
+                    cube.set(i, j, index, color);
+                    break;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Draw a line between two voxels with 3D Bresenham
+ *
+ * Both end points must be inside the cube.
+ */
+template <typename Cube>
+void drawLine(Cube &cube, int x0, int y0, int z0, int x1, int y1, int z1,
+              typename Cube::color_type color) {
+    int dx = abs(x1 - x0), dy = abs(y1 - y0), dz = abs(z1 - z0);
+    int sx = x1 > x0 ? 1 : -1, sy = y1 > y0 ? 1 : -1, sz = z1 > z0 ? 1 : -1;
+    int n = std::max(dx, std::max(dy, dz));
+    // 误差项, 以最长的轴为步进轴
+    int ex = n / 2, ey = n / 2, ez = n / 2;
+    for (int i = 0; i <= n; i++) {
+        cube.set(x0, y0, z0, color);
+        ex -= dx;
+        ey -= dy;
+        ez -= dz;
+        if (ex < 0) {
+            ex += n;
+            x0 += sx;
+        }
+        if (ey < 0) {
+            ey += n;
+            y0 += sy;
+        }
+        if (ez < 0) {
+            ez += n;
+            z0 += sz;
+        }
+    }
+}
+
+/**
+ * @brief Draw the set voxels of a sprite, clipped to the cube
+ *
+ * @param cube cube to draw on
+ * @param sprite sprite to draw
+ * @param x x of the sprite origin, may be outside the cube
+ * @param y y of the sprite origin, may be outside the cube
+ * @param z z of the sprite origin, may be outside the cube
+ * @param color color of the set voxels
+ */
+template <typename Cube>
+void drawSprite(Cube &cube, const VoxelSprite &sprite, int x, int y, int z,
+                typename Cube::color_type color) {
+    for (int k = 0; k < sprite.d; k++) {
+        int cz = z + k;
+        if (cz < 0 || cz >= cube.h()) {
+            continue;
+        }
+        for (int j = 0; j < sprite.h; j++) {
+            int cy = y + j;
+            if (cy < 0 || cy >= cube.w()) {
+                continue;
+            }
+            for (int i = 0; i < sprite.w; i++) {
+                int cx = x + i;
+                if (cx >= 0 && cx < cube.l() && sprite.test(i, j, k)) {
+                    cube.set(cx, cy, cz, color);
+                }
+            }
+        }
+    }
+}
+
+#endif // __CUBERENDERER_HPP__
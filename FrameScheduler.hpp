@@ -0,0 +1,188 @@
+#ifndef __FRAMESCHEDULER_HPP__
+#define __FRAMESCHEDULER_HPP__
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+/**
+ * @brief Cooperative frame scheduler driven from loop()
+ *
+ * Deadlines are kept in microseconds, and the fractional part of the frame
+ * period is carried over, so the average frame rate is exact. A frame that is
+ * more than one period late drops the missed deadlines instead of rendering a
+ * burst of frames to catch up.
+ */
+class FrameScheduler {
+private:
+    uint16_t rate;
+    uint32_t period;   // 帧周期的整数部分 (us)
+    uint32_t fraction; // 帧周期小数部分的累计, 单位 1/rate us
+    uint32_t deadline;
+
+    uint32_t frameCount;
+    uint32_t lateCount;
+    uint32_t dropCount;
+    uint32_t minLateness;
+    uint32_t maxLateness;
+    uint64_t sumLateness;
+
+    void advance() {
+        deadline += period;
+        fraction += 1000000 % rate;
+        if (fraction >= rate) {
+            fraction -= rate;
+            deadline++;
+        }
+    }
+
+public:
+    FrameScheduler() : rate(60), period(1000000 / 60), fraction(0), deadline(0) {
+        reset();
+    }
+
+    /**
+     * @brief Change the frame rate, starting from the pending deadline
+     *
+     * A deadline still ahead is kept: the frame for it may already be
+     * rendered, and moving it earlier would make the time handed to effects
+     * go backwards. Only a deadline in the past restarts at the current time.
+     *
+     * @param rate frames per second
+     */
+    void setRate(uint16_t rate) {
+        this->rate = rate;
+        this->period = 1000000 / rate;
+        this->fraction = 0;
+        uint32_t now = micros();
+        if (due(now)) {
+            this->deadline = now;
+        }
+    }
+
+    uint32_t frames() const {
+        return frameCount;
+    }
+
+    // 下一帧的截止时间 (us)
+    uint32_t nextDeadline() const {
+        return deadline;
+    }
+
+    // 距离下一帧截止时间的微秒数, 已超时则为负数
+    int32_t remaining(uint32_t now) const {
+        return (int32_t) (deadline - now);
+    }
+
+    bool due(uint32_t now) const {
+        return remaining(now) <= 0;
+    }
+
+    /**
+     * @brief Start a frame, record its lateness and schedule the next one
+     *
+     * @param now current time in microseconds
+     */
+    void next(uint32_t now) {
+        uint32_t lateness = now - deadline;
+        frameCount++;
+        minLateness = std::min(minLateness, lateness);
+        maxLateness = std::max(maxLateness, lateness);
+        sumLateness += lateness;
+        if (lateness > period / 4) {
+            lateCount++;
+        }
+        advance();
+        // 落后超过一帧时直接跳过错过的帧, 灯效按实际经过的时间更新, 不会变慢
+        while (due(now)) {
+            dropCount++;
+            advance();
+        }
+    }
+
+    /**
+     * @brief Whether a service should wait until after the next frame
+     *
+     * @param now current time in microseconds
+     * @param budget expected run time of the service in microseconds
+     * @param lastFrame frames() when the service last ran
+     * @param maxDefer frames after which the service runs regardless of the time left
+     */
+    bool defer(uint32_t now, uint32_t budget, uint32_t lastFrame, uint32_t maxDefer) const {
+        return remaining(now) < (int32_t) budget && frameCount - lastFrame < maxDefer;
+    }
+
+    void reset() {
+        frameCount = 0;
+        lateCount = 0;
+        dropCount = 0;
+        minLateness = UINT32_MAX;
+        maxLateness = 0;
+        sumLateness = 0;
+    }
+
+    void writeToJSON(JsonDocument &json) const {
+        json["fps"] = rate;
+        json["period"] = period;
+        json["frames"] = frameCount;
+        json["late"] = lateCount;
+        json["dropped"] = dropCount;
+        json["jitterMin"] = frameCount > 0 ? minLateness : 0;
+        json["jitterMax"] = maxLateness;
+        json["jitterAvg"] = frameCount > 0 ? (uint32_t) (sumLateness / frameCount) : 0;
+    }
+};
+
+/**
+ * @brief Ring of recent frame timings, relative to each frame's deadline
+ *
+ * A negative render time means the frame was computed ahead of its deadline,
+ * overlapping the idle time after the previous frame was shifted out.
+ */
+template <int N>
+class FrameTrace {
+private:
+    struct Entry {
+        uint32_t deadline;
+        uint32_t renderStart;
+        uint32_t renderEnd;
+        uint32_t showStart;
+        uint32_t showEnd;
+    };
+
+    Entry entries[N];
+    Entry current;
+    int head;
+    int count;
+
+public:
+    FrameTrace() : head(0), count(0) {
+        memset(&current, 0, sizeof(current));
+    }
+
+    void render(uint32_t start, uint32_t end) {
+        current.renderStart = start;
+        current.renderEnd = end;
+    }
+
+    void show(uint32_t deadline, uint32_t start, uint32_t end) {
+        current.deadline = deadline;
+        current.showStart = start;
+        current.showEnd = end;
+        entries[head] = current;
+        head = (head + 1) % N;
+        count = std::min(count + 1, N);
+    }
+
+    void writeToJSON(JsonArray &array) const {
+        for (int i = 0; i < count; i++) {
+            const Entry &entry = entries[(head - count + i + N) % N];
+            JsonObject obj = array.createNestedObject();
+            obj["renderStart"] = (int32_t) (entry.renderStart - entry.deadline);
+            obj["renderEnd"] = (int32_t) (entry.renderEnd - entry.deadline);
+            obj["showStart"] = (int32_t) (entry.showStart - entry.deadline);
+            obj["showEnd"] = (int32_t) (entry.showEnd - entry.deadline);
+        }
+    }
+};
+
+#endif // __FRAMESCHEDULER_HPP__
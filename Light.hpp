@@ -7,6 +7,160 @@
 #include "config.h"
 #include "utils.h"
 
+// 灯珠数组的容量, 灯珠数在运行时确定的灯取其最大值
+template <typename Light>
+struct LightCapacity {
+    static constexpr int value = Light::count();
+};
+
+/**
+ * @brief Table of uint16_t in PROGMEM, generated at compile time
+ *
+ * @tparam Generator type with static constexpr size() and value(int)
+ */
+template <typename Generator, typename Seq = typename make_index_seq<Generator::size()>::type>
+struct LookupTable;
+
+template <typename Generator, size_t... I>
+struct LookupTable<Generator, index_seq<I...>> {
+    static const uint16_t table[sizeof...(I)];
+
+    static uint16_t get(int i) {
+        return pgm_read_word(&table[i]);
+    }
+};
+
+template <typename Generator, size_t... I>
+const uint16_t LookupTable<Generator, index_seq<I...>>::table[sizeof...(I)] PROGMEM = {
+    (uint16_t) Generator::value(I)...
+};
+
+/**
+ * @brief Coordinate of an LED passed to pixel shaders, each axis scaled to 0-255
+ *
+ * Strips use x, panels x and y, cubes x, y and z, from the first to the last
+ * LED along the axis. Discs use polar coordinates: x is the angle (256 for a
+ * full turn) and y the radius (255 for the largest ring).
+ */
+struct LightPoint {
+    uint8_t x;
+    uint8_t y;
+    uint8_t z;
+};
+
+// 长度为 N 的轴上第 i 个灯珠的坐标, 两端分别为 0 和 255
+template <int N>
+struct AxisGenerator {
+    static constexpr int size() {
+        return N;
+    }
+
+    static constexpr int value(int i) {
+        return N > 1 ? i * 255 / (N - 1) : 0;
+    }
+};
+
+template <int N>
+using Axis = LookupTable<AxisGenerator<N>>;
+
+/**
+ * @brief Walk i * range / divisor for i = 0, 1, 2... in Q16 fixed point
+ *
+ * Gives the same coordinates as the compile-time tables (for lines of up to
+ * 256 LEDs) to lights sized at runtime, with one division per line instead of
+ * one per LED.
+ */
+class AxisWalker {
+private:
+    uint32_t value;
+    uint32_t step;
+
+public:
+    AxisWalker(int range, int divisor) :
+        value(0), step(divisor > 0 ? (((uint32_t) range << 16) + divisor - 1) / divisor : 0) {}
+
+    uint8_t next() {
+        uint8_t v = value >> 16;
+        value += step;
+        return v;
+    }
+};
+
+/**
+ * @brief Contiguous LEDs in memory order
+ */
+struct LightRange {
+    CRGB *leds;
+    int n;
+
+    int size() const {
+        return n;
+    }
+
+    CRGB* begin() const {
+        return leds;
+    }
+
+    CRGB* end() const {
+        return leds + n;
+    }
+};
+
+/**
+ * @brief Line of LEDs visited through an index table
+ */
+class LightSpan {
+private:
+    CRGB *leds;
+    const uint16_t *index; // 首个灯珠在索引表中的位置
+    int step;              // 相邻灯珠在索引表中的间隔
+    int n;
+
+public:
+    class iterator {
+    private:
+        CRGB *leds;
+        const uint16_t *index;
+        int step;
+
+    public:
+        iterator(CRGB *leds, const uint16_t *index, int step) :
+            leds(leds), index(index), step(step) {}
+
+        CRGB& operator*() const {
+            return leds[pgm_read_word(index)];
+        }
+
+        iterator& operator++() {
+            index += step;
+            return *this;
+        }
+
+        bool operator!=(const iterator &other) const {
+            return index != other.index;
+        }
+    };
+
+    LightSpan(CRGB *leds, const uint16_t *index, int step, int n) :
+        leds(leds), index(index), step(step), n(n) {}
+
+    int size() const {
+        return n;
+    }
+
+    CRGB& operator[](int i) const {
+        return leds[pgm_read_word(index + i * step)];
+    }
+
+    iterator begin() const {
+        return iterator(leds, index, step);
+    }
+
+    iterator end() const {
+        return iterator(leds, index + n * step, step);
+    }
+};
+
 // ==================== LightStrip ====================
 
 template <int COUNT, bool REVERSE>
@@ -17,7 +171,7 @@ public:
     }
 
 private:
-    CRGB leds[count()];
+    alignas(4) CRGB leds[count()]; // 4 字节对齐以便按字处理
 public:
     CRGB* data() {
         return this->leds;
@@ -35,6 +189,36 @@ public:
             return this->leds[i];
         }
     }
+
+    static constexpr int slices() {
+        return COUNT;
+    }
+
+    void fillSlice(int slice, CRGB color) {
+        at(slice) = color;
+    }
+
+    /**
+     * @brief Compute every LED from its coordinate
+     *
+     * @param f function from LightPoint to color
+     */
+    template <typename F>
+    void shadePixels(F f) {
+        for (int i = 0; i < COUNT; i++) {
+            this->leds[indexOf(i)] = f(LightPoint{(uint8_t) Axis<COUNT>::get(i), 0, 0});
+        }
+    }
+
+    // 逻辑位置对应的灯珠序号
+    static constexpr int indexOf(int pos) {
+        return REVERSE ? COUNT - pos - 1 : pos;
+    }
+
+    // 灯珠序号对应的逻辑位置
+    static constexpr int positionOf(int index) {
+        return indexOf(index);
+    }
 };
 
 // ==================== LightPanel ====================
@@ -48,6 +232,44 @@ enum LightPanelArrangement {
     FLIP       = 0x8, // 翻转
 };
 
+// 按排列方式交换行列后第 line 行是否从右往左排列
+constexpr bool panel_reversed(int arrangement, int line) {
+    return ((arrangement & SNAKE) && line % 2 == 1) != bool(arrangement & MIRROR);
+}
+
+// 交换行列后第 line 行第 column 个灯珠的序号, stride 为每行灯珠数, lines 为行数
+constexpr int panel_place(int stride, int lines, int arrangement, int line, int column) {
+    return (arrangement & FLIP ? lines - line - 1 : line) * stride +
+           (panel_reversed(arrangement, line) ? stride - column - 1 : column);
+}
+
+constexpr int panel_line(int stride, int lines, int arrangement, int index) {
+    return arrangement & FLIP ? lines - index / stride - 1 : index / stride;
+}
+
+constexpr int panel_column(int stride, int arrangement, int line, int index) {
+    return panel_reversed(arrangement, line) ? stride - index % stride - 1 : index % stride;
+}
+
+/**
+ * @brief LED index of (x, y) on a w * h panel
+ *
+ * Shared by LightPanel, which bakes it into a table at compile time, and
+ * runtime layouts, which build the same table at boot.
+ */
+constexpr int panel_index(int w, int h, int arrangement, int x, int y) {
+    return arrangement & VERTICAL ? panel_place(h, w, arrangement, x, y) : panel_place(w, h, arrangement, y, x);
+}
+
+// 灯珠序号对应的逻辑位置 (y * w + x), 即 panel_index 的逆运算
+constexpr int panel_position(int w, int h, int arrangement, int index) {
+    return arrangement & VERTICAL
+               ? panel_column(h, arrangement, panel_line(h, w, arrangement, index), index) * w +
+                     panel_line(h, w, arrangement, index)
+               : panel_line(w, h, arrangement, index) * w +
+                     panel_column(w, arrangement, panel_line(w, h, arrangement, index), index);
+}
+
 template <int X_COUNT, int Y_COUNT, int ARRANGEMENT>
 class LightPanel {
 public:
@@ -56,7 +278,7 @@ public:
     }
 
 private:
-    CRGB leds[count()];
+    alignas(4) CRGB leds[count()]; // 4 字节对齐以便按字处理
 public:
     CRGB* data() {
         return this->leds;
@@ -72,24 +294,72 @@ public:
     }
 
     CRGB& at(int x, int y) {
-        int _w = w();
-        int _h = h();
-        if (ARRANGEMENT & VERTICAL) {
-            std::swap(x, y);
-            std::swap(_w, _h);
-        }
-        if (ARRANGEMENT & SNAKE) {
-            if (y % 2 == 1) {
-                x = _w - x - 1;
-            }
+        return this->leds[index(x, y)];
+    }
+
+    // 第 y 行, 从左到右
+    LightSpan row(int y) {
+        return LightSpan(this->leds, &Indices::table[y * X_COUNT], 1, X_COUNT);
+    }
+
+    // 第 x 列, 从上到下
+    LightSpan column(int x) {
+        return LightSpan(this->leds, &Indices::table[x], X_COUNT, Y_COUNT);
+    }
+
+private:
+    struct IndexGenerator;
+    typedef LookupTable<IndexGenerator> Indices;
+
+    // 非蛇形排列的序号是 x, y 的线性函数, 直接计算比查表快, 蛇形排列每行方向交替, 查表
+    static int index(int x, int y) {
+        return ARRANGEMENT & SNAKE ? Indices::get(y * X_COUNT + x) : panel_index(X_COUNT, Y_COUNT, ARRANGEMENT, x, y);
+    }
+
+    struct IndexGenerator {
+        static constexpr int size() {
+            return count();
         }
-        if (ARRANGEMENT & MIRROR) {
-            x = _w - x - 1;
+
+        static constexpr int value(int pos) {
+            return indexOf(pos);
         }
-        if (ARRANGEMENT & FLIP) {
-            y = _h - y - 1;
+    };
+
+public:
+    // 逻辑位置 (y * w + x) 对应的灯珠序号
+    static constexpr int indexOf(int pos) {
+        return panel_index(X_COUNT, Y_COUNT, ARRANGEMENT, pos % X_COUNT, pos / X_COUNT);
+    }
+
+    // 灯珠序号对应的逻辑位置, 即 indexOf 的逆运算
+    static constexpr int positionOf(int index) {
+        return panel_position(X_COUNT, Y_COUNT, ARRANGEMENT, index);
+    }
+
+    static constexpr int slices() {
+        return Y_COUNT;
+    }
+
+    void fillSlice(int slice, CRGB color) {
+        for (CRGB &led : row(slice)) {
+            led = color;
+        }
+    }
+
+    /**
+     * @brief Compute every LED from its coordinate
+     *
+     * @param f function from LightPoint to color
+     */
+    template <typename F>
+    void shadePixels(F f) {
+        for (int y = 0; y < Y_COUNT; y++) {
+            uint8_t py = Axis<Y_COUNT>::get(y);
+            for (int x = 0; x < X_COUNT; x++) {
+                this->leds[index(x, y)] = f(LightPoint{(uint8_t) Axis<X_COUNT>::get(x), py, 0});
+            }
         }
-        return this->leds[y * _w + x];
     }
 };
 
@@ -116,7 +386,7 @@ public:
     }
 
 private:
-    CRGB leds[count()];
+    alignas(4) CRGB leds[count()]; // 4 字节对齐以便按字处理
 public:
     CRGB* data() {
         return this->leds;
@@ -135,12 +405,130 @@ public:
         if (ARRANGEMENT & ANTICLOCKWISE) {
             i = l(ring) - i - 1;
         }
-        if (ARRANGEMENT & INSIDE_OUT) {
-            return this->leds[sum(rings + ring + 1, rings + r(), 0) + i];
-        } else {
-            return this->leds[sum(rings, rings + ring, 0) + i];
+        return this->leds[Offsets::get(ring) + i];
+    }
+
+    // 第 ring 环的灯珠, 按内存顺序
+    LightRange ring(int ring) {
+        return LightRange{this->leds + Offsets::get(ring), l(ring)};
+    }
+
+    /**
+     * @brief Call f(ring, range) for every ring
+     *
+     * @param f function taking the ring index and its LightRange
+     */
+    template <typename F>
+    void forEachRing(F f) {
+        for (int i = 0; i < r(); i++) {
+            f(i, ring(i));
+        }
+    }
+
+private:
+    // 每环首个灯珠的序号, 即按存储顺序的前缀和
+    struct OffsetGenerator {
+        static constexpr int size() {
+            return ring_count();
+        }
+
+        static constexpr int value(int ring) {
+            return ARRANGEMENT & INSIDE_OUT ? sum(rings + ring + 1, rings + ring_count(), 0)
+                                            : sum(rings, rings + ring, 0);
+        }
+    };
+
+    typedef LookupTable<OffsetGenerator> Offsets;
+
+    static constexpr int ringOf(int index, int ring) {
+        return index < rings[ring] ? ring : ringOf(index - rings[ring], ring + 1);
+    }
+
+    static constexpr int ringOfReversed(int index, int ring) {
+        return index < rings[ring] ? ring : ringOfReversed(index - rings[ring], ring - 1);
+    }
+
+    static constexpr int ringOfIndex(int index) {
+        return ARRANGEMENT & INSIDE_OUT ? ringOfReversed(index, ring_count() - 1) : ringOf(index, 0);
+    }
+
+    static constexpr int angleOf(int ring, int pos) {
+        return (ARRANGEMENT & ANTICLOCKWISE ? rings[ring] - pos - 1 : pos) * 256 / rings[ring];
+    }
+
+    // 灯珠等距排列, 环的半径与灯珠数成正比, 最大的环为 255
+    static constexpr int radiusOf(int ring) {
+        return rings[ring] * 255 / max_of(COUNT_PER_RING...);
+    }
+
+    // 每个灯珠的极坐标, 高 8 位为角度, 低 8 位为半径
+    struct PolarGenerator {
+        static constexpr int size() {
+            return count();
+        }
+
+        static constexpr int value(int index) {
+            return angleOf(ringOfIndex(index), index - OffsetGenerator::value(ringOfIndex(index))) << 8 |
+                   radiusOf(ringOfIndex(index));
+        }
+    };
+
+    typedef LookupTable<PolarGenerator> Polars;
+
+public:
+    // 灯珠的角度, 256 为一周, 从每环第 0 个灯珠起按顺时针方向增大
+    static uint8_t angle(int index) {
+        return Polars::get(index) >> 8;
+    }
+
+    // 灯珠的半径, 最大的环为 255
+    static uint8_t radius(int index) {
+        return Polars::get(index) & 0xFF;
+    }
+
+    /**
+     * @brief Compute every LED from its polar coordinates
+     *
+     * @param f function from LightPoint to color, x is the angle and y the radius
+     */
+    template <typename F>
+    void shadePixels(F f) {
+        for (int i = 0; i < count(); i++) {
+            uint16_t polar = Polars::get(i);
+            this->leds[i] = f(LightPoint{(uint8_t) (polar >> 8), (uint8_t) (polar & 0xFF), 0});
+        }
+    }
+
+    /**
+     * @brief Call f(led) for every LED whose angle is in [from, to)
+     *
+     * Angles of a ring grow with the index, so the LEDs of a sector are one
+     * run per ring, found with a multiply instead of scanning the ring.
+     * The sector wraps around when to <= from.
+     *
+     * @param from start angle, 256 for a full turn
+     * @param to end angle, exclusive
+     * @param f function taking CRGB&
+     */
+    template <typename F>
+    void forEachInSector(uint8_t from, uint8_t to, F f) {
+        int end = to > from ? to : to + 256;
+        for (int ring = 0; ring < r(); ring++) {
+            int n = l(ring);
+            // 角度在 [from, end) 中的第一个和最后一个之后的位置
+            for (int i = (from * n + 255) / 256, last = (end * n + 255) / 256; i < last; i++) {
+                f(at(ring, i % n));
+            }
         }
     }
+
+    static constexpr int slices() {
+        return ring_count();
+    }
+
+    void fillSlice(int slice, CRGB color) {
+        fill_solid(this->leds + Offsets::get(slice), l(slice), color);
+    }
 };
 
 template <int ARRANGEMENT, int... COUNT_PER_RING>
@@ -156,7 +544,7 @@ public:
     }
 
 private:
-    CRGB leds[count()];
+    alignas(4) CRGB leds[count()]; // 4 字节对齐以便按字处理
 public:
     CRGB* data() { return this->leds; }
 
@@ -176,6 +564,356 @@ public:
     CRGB& at(int x, int y, int z) {
         return this->leds[z * l() * w() + y * l() + x];
     }
+
+    typedef CRGB color_type;
+
+    void set(int x, int y, int z, CRGB color) {
+        at(x, y, z) = color;
+    }
+
+    static constexpr int slices() {
+        return Z_COUNT;
+    }
+
+    void fillSlice(int slice, CRGB color) {
+        fill_solid(this->leds + slice * X_COUNT * Y_COUNT, X_COUNT * Y_COUNT, color);
+    }
+
+    /**
+     * @brief Compute every LED from its coordinate
+     *
+     * @param f function from LightPoint to color
+     */
+    template <typename F>
+    void shadePixels(F f) {
+        CRGB *led = this->leds;
+        for (int z = 0; z < Z_COUNT; z++) {
+            uint8_t pz = Axis<Z_COUNT>::get(z);
+            for (int y = 0; y < Y_COUNT; y++) {
+                uint8_t py = Axis<Y_COUNT>::get(y);
+                for (int x = 0; x < X_COUNT; x++) {
+                    *led++ = f(LightPoint{(uint8_t) Axis<X_COUNT>::get(x), py, pz});
+                }
+            }
+        }
+    }
+};
+
+// ==================== PackedPixels ====================
+
+/**
+ * @brief Pointer to LEDs kept in a compact pixel format
+ *
+ * Returned by data() of a light whose render buffer is packed. Indexing
+ * yields a reference that packs a CRGB on assignment and unpacks it on read,
+ * so effects written against CRGB * render into it unchanged.
+ *
+ * @tparam Format pixel format with pixel_type, pack(CRGB) and decode(pixel_type)
+ */
+template <typename Format>
+class PackedPixels {
+public:
+    typedef typename Format::pixel_type pixel_type;
+
+    class Ref {
+    private:
+        pixel_type *pixel;
+        const Format *format;
+
+    public:
+        Ref(pixel_type *pixel, const Format *format) : pixel(pixel), format(format) {}
+
+        Ref& operator=(const CRGB &color) {
+            *pixel = format->pack(color);
+            return *this;
+        }
+
+        Ref& operator=(const Ref &other) {
+            *pixel = *other.pixel;
+            return *this;
+        }
+
+        operator CRGB() const {
+            return format->decode(*pixel);
+        }
+    };
+
+private:
+    pixel_type *pixels;
+    const Format *format;
+
+public:
+    PackedPixels(pixel_type *pixels, const Format *format) : pixels(pixels), format(format) {}
+
+    Ref operator[](int i) const {
+        return Ref(pixels + i, format);
+    }
+
+    PackedPixels operator+(int i) const {
+        return PackedPixels(pixels + i, format);
+    }
+
+    pixel_type* raw() const {
+        return pixels;
+    }
+
+    const Format& pixelFormat() const {
+        return *format;
+    }
+};
+
+// 颜色只压缩一次, 再按像素填充
+template <typename Format>
+void fill_solid(PackedPixels<Format> leds, int count, const CRGB &color) {
+    typename Format::pixel_type pixel = leds.pixelFormat().pack(color);
+    std::fill(leds.raw(), leds.raw() + count, pixel);
+}
+
+// 复制一段灯珠, 两端为 CRGB 或同一格式的压缩像素, 需要时转换格式
+inline void copy_pixels(CRGB *dst, const CRGB *src, int count) {
+    memcpy(dst, src, count * sizeof(CRGB));
+}
+
+template <typename Format>
+void copy_pixels(PackedPixels<Format> dst, PackedPixels<Format> src, int count) {
+    memcpy(dst.raw(), src.raw(), count * sizeof(typename Format::pixel_type));
+}
+
+template <typename Format>
+void copy_pixels(PackedPixels<Format> dst, const CRGB *src, int count) {
+    const Format &format = dst.pixelFormat();
+    for (int i = 0; i < count; i++) {
+        dst.raw()[i] = format.pack(src[i]);
+    }
+}
+
+template <typename Format>
+void copy_pixels(CRGB *dst, PackedPixels<Format> src, int count) {
+    const Format &format = src.pixelFormat();
+    for (int i = 0; i < count; i++) {
+        dst[i] = format.decode(src.raw()[i]);
+    }
+}
+
+// ==================== LightSegment ====================
+
+/**
+ * @brief Run of LEDs inside another light, sized at runtime
+ *
+ * Lets an effect draw a segment of a strip as if it was a strip of its own.
+ */
+class LightSegment {
+private:
+    CRGB *leds;
+    int n;
+
+public:
+    LightSegment(CRGB *leds, int n) : leds(leds), n(n) {}
+
+    CRGB* data() {
+        return this->leds;
+    }
+
+    int count() const {
+        return n;
+    }
+
+    int l() const {
+        return n;
+    }
+
+    CRGB& at(int i) {
+        return this->leds[i];
+    }
+
+    int slices() const {
+        return n;
+    }
+
+    void fillSlice(int slice, CRGB color) {
+        this->leds[slice] = color;
+    }
+
+    template <typename F>
+    void shadePixels(F f) {
+        AxisWalker x(255, n - 1);
+        for (int i = 0; i < n; i++) {
+            this->leds[i] = f(LightPoint{x.next(), 0, 0});
+        }
+    }
+};
+
+/**
+ * @brief Fill every slice with a color computed from its index
+ *
+ * Slices are the lines along which effects move: LEDs of a strip, rows of a
+ * panel, rings of a disc and layers of a cube. The shader runs once per
+ * slice, and each light fills a slice through its own layout, so one effect
+ * kernel works on every topology. Effects that need the position of each LED
+ * use shadePixels(f) of the light instead, see LightPoint.
+ *
+ * @param light light to draw
+ * @param shader function from slice index to color
+ */
+template <typename Light, typename Shader>
+void shade(Light &light, Shader shader) {
+    for (int i = 0; i < light.slices(); i++) {
+        light.fillSlice(i, shader(i));
+    }
+}
+
+// ==================== MultiOutput ====================
+
+// 多路输出按逻辑位置切分灯珠, 只有 LightStrip 和 LightPanel 支持
+template <typename Light>
+struct SupportsMultiOutput {
+    static constexpr bool value = false;
+};
+
+template <int COUNT, bool REVERSE>
+struct SupportsMultiOutput<LightStrip<COUNT, REVERSE>> {
+    static constexpr bool value = true;
+};
+
+template <int X_COUNT, int Y_COUNT, int ARRANGEMENT>
+struct SupportsMultiOutput<LightPanel<X_COUNT, Y_COUNT, ARRANGEMENT>> {
+    static constexpr bool value = true;
+};
+
+/**
+ * @brief Light driven through several data pins at once
+ *
+ * The logical light is cut by logical position into OUTPUTS equal parts, in
+ * order, and each part is wired as an Output of its own, e.g. a 16x16 panel
+ * as four 16x4 panels, each starting its own snake. Effects draw the logical
+ * light as usual. The frame is then rearranged through a table generated at
+ * compile time into one block per output, the layout expected by the
+ * parallel FastLED controller.
+ *
+ * @tparam Light logical light, LightStrip or LightPanel
+ * @tparam Output light wired to each pin, same type family as Light
+ * @tparam OUTPUTS number of data pins
+ */
+template <typename Light, typename Output, int OUTPUTS>
+class MultiOutput : public Light {
+    static_assert(SupportsMultiOutput<Light>::value && SupportsMultiOutput<Output>::value,
+                  "MultiOutput only supports LightStrip and LightPanel!");
+    static_assert(Light::count() == Output::count() * OUTPUTS, "Output size mismatch!");
+
+private:
+    // 逻辑灯珠序号对应的输出缓冲序号
+    struct OutputGenerator {
+        static constexpr int size() {
+            return Light::count();
+        }
+
+        static constexpr int value(int index) {
+            return Light::positionOf(index) / Output::count() * Output::count() +
+                   Output::indexOf(Light::positionOf(index) % Output::count());
+        }
+    };
+
+    typedef LookupTable<OutputGenerator> OutputMap;
+
+public:
+    static constexpr int outputs() {
+        return OUTPUTS;
+    }
+
+    // 每路输出的灯珠数
+    static constexpr int countPerOutput() {
+        return Output::count();
+    }
+
+    /**
+     * @brief Rearrange a rendered frame into per-output blocks
+     *
+     * @param dst output buffer of count() LEDs
+     * @param src rendered frame
+     */
+    static void copyToOutputs(CRGB *dst, const CRGB *src) {
+        for (int i = 0; i < Light::count(); i++) {
+            dst[OutputMap::get(i)] = src[i];
+        }
+    }
+
+    /**
+     * @brief Rearrange a range of LEDs of a rendered frame, scaled
+     *
+     * @param dst output buffer of count() LEDs
+     * @param src rendered frame
+     * @param start first LED of the range, as indexed in src
+     * @param length number of LEDs in the range
+     * @param brightness scale of the copied LEDs
+     */
+    static void copyToOutputs(CRGB *dst, const CRGB *src, int start, int length, uint8_t brightness) {
+        for (int i = start; i < start + length; i++) {
+            CRGB &led = dst[OutputMap::get(i)];
+            led = src[i];
+            if (brightness < 255) {
+                led.nscale8(brightness);
+            }
+        }
+    }
+};
+
+// 把渲染好的帧复制到输出缓冲, 多路输出时按输出重新排列
+template <typename Light>
+void copy_to_output(const Light &light, CRGB *dst, const CRGB *src) {
+    memcpy(dst, src, light.count() * sizeof(CRGB));
+}
+
+template <typename Light, typename Output, int OUTPUTS>
+void copy_to_output(const MultiOutput<Light, Output, OUTPUTS> &light, CRGB *dst, const CRGB *src) {
+    MultiOutput<Light, Output, OUTPUTS>::copyToOutputs(dst, src);
+}
+
+// 压缩格式的渲染帧在复制时展开为 CRGB
+template <typename Light, typename Format>
+void copy_to_output(const Light &light, CRGB *dst, PackedPixels<Format> src) {
+    copy_pixels(dst, src, light.count());
+}
+
+// 把渲染好的帧中的一段按亮度缩放后复制到输出缓冲, 多路输出时按输出重新排列
+template <typename Light>
+void copy_to_output(const Light &light, CRGB *dst, const CRGB *src, int start, int length, uint8_t brightness) {
+    memcpy(dst + start, src + start, length * sizeof(CRGB));
+    if (brightness < 255) {
+        nscale8(dst + start, length, brightness);
+    }
+}
+
+template <typename Light, typename Output, int OUTPUTS>
+void copy_to_output(const MultiOutput<Light, Output, OUTPUTS> &light, CRGB *dst, const CRGB *src,
+                    int start, int length, uint8_t brightness) {
+    MultiOutput<Light, Output, OUTPUTS>::copyToOutputs(dst, src, start, length, brightness);
+}
+
+// ==================== DoubleBuffer ====================
+
+/**
+ * @brief Light with a front buffer for output and a back buffer for rendering
+ *
+ * Effects render into data() as usual while the front buffer holds the frame
+ * being shifted out. swap() publishes the back buffer at a frame boundary by
+ * copying it, so effects that draw incrementally keep their previous frame.
+ * For a MultiOutput light the copy also rearranges the LEDs per output, and
+ * for a light rendering in a packed format such as PackedCube it expands the
+ * frame, so only the front buffer read by FastLED takes a full CRGB frame.
+ */
+template <typename Light>
+class DoubleBuffer : public Light {
+private:
+    alignas(4) CRGB frontLeds[LightCapacity<Light>::value];
+
+public:
+    CRGB* front() {
+        return this->frontLeds;
+    }
+
+    void swap() {
+        copy_to_output(static_cast<const Light &>(*this), this->frontLeds, this->data());
+    }
 };
 
 #endif // __LIGHT_HPP__
@@ -0,0 +1,660 @@
+#ifndef __LIGHTCOMPOSITOR_HPP__
+#define __LIGHTCOMPOSITOR_HPP__
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include <ArduinoJson.h>
+#include <memory>
+#include <new>
+
+#include "config.h"
+#include "Light.hpp"
+#include "LightEffect.hpp"
+
+enum BlendMode {
+    BLEND_ADD,      // 饱和相加
+    BLEND_ALPHA,    // 按不透明度混合
+    BLEND_MAX,      // 逐通道取最大
+    BLEND_MULTIPLY, // 逐通道相乘
+    BLEND_MASK,     // 仅保留上层通道非 0 处的下层颜色
+    BLEND_MODE_COUNT
+};
+
+/**
+ * @brief Get blend mode enum from name
+ *
+ * @param str blend mode name
+ * @return BlendMode blend mode enum
+ */
+BlendMode str2blend(const char *str);
+
+/**
+ * @brief Get name from blend mode enum
+ *
+ * @param mode blend mode enum
+ * @return const char* blend mode name
+ */
+const char* blend2str(BlendMode mode);
+
+// 混合内核以 32 位字为单位一次处理 4 个通道, 要求帧缓冲 4 字节对齐 (见 Light.hpp)
+typedef uint32_t __attribute__((__may_alias__)) packed_t;
+
+#define PACKED_LO 0x00FF00FFu
+#define PACKED_HI 0x80808080u
+
+// 每个通道乘以 scale / 256, scale 取值 0~256
+inline packed_t packed_scale(packed_t a, uint16_t scale) {
+    return (((a & PACKED_LO) * scale >> 8) & PACKED_LO) |
+           ((((a >> 8) & PACKED_LO) * scale) & ~PACKED_LO);
+}
+
+// 每个通道 a + (b - a) * alpha / 256, alpha 取值 0~256
+inline packed_t packed_lerp(packed_t a, packed_t b, uint16_t alpha) {
+    return packed_scale(a, 256 - alpha) + packed_scale(b, alpha);
+}
+
+inline packed_t packed_qadd(packed_t a, packed_t b) {
+    packed_t sum = ((a & ~PACKED_HI) + (b & ~PACKED_HI)) ^ ((a ^ b) & PACKED_HI);
+    packed_t carry = ((a & b) | ((a | b) & ~sum)) & PACKED_HI;
+    return sum | ((carry >> 7) * 0xFF);
+}
+
+inline packed_t packed_max(packed_t a, packed_t b) {
+    packed_t diff = ((a | PACKED_HI) - (b & ~PACKED_HI)) ^ ((a ^ ~b) & PACKED_HI);
+    packed_t borrow = ((~a & b) | ((~a | b) & diff)) & PACKED_HI;
+    return b + (diff & ~((borrow >> 7) * 0xFF)); // b + max(a - b, 0), 各通道不会进位
+}
+
+inline packed_t packed_mask(packed_t a, packed_t b) {
+    packed_t nonzero = (((b & ~PACKED_HI) + ~PACKED_HI) | b) & PACKED_HI;
+    return a & ((nonzero >> 7) * 0xFF);
+}
+
+inline uint8_t channel_blend(uint8_t a, uint8_t b, BlendMode mode, uint16_t scale) {
+    switch (mode) {
+        case BLEND_ADD:
+            return qadd8(a, b * scale >> 8);
+        case BLEND_ALPHA:
+            return (a * (256 - scale) >> 8) + (b * scale >> 8);
+        case BLEND_MAX:
+            b = b * scale >> 8;
+            return a > b ? a : b;
+        case BLEND_MULTIPLY:
+            return a * (b + 1) >> 8;
+        case BLEND_MASK:
+            return b ? a : 0;
+        default:
+            return a;
+    }
+}
+
+/**
+ * @brief Blend a frame onto another frame in place
+ *
+ * @param dst destination frame, must be 4-byte aligned
+ * @param src source frame, must be 4-byte aligned
+ * @param count number of LEDs
+ * @param mode blend mode
+ * @param opacity opacity of source frame (0-255), ignored by multiply and mask
+ */
+inline void blend_frame(CRGB *dst, const CRGB *src, int count, BlendMode mode, uint8_t opacity) {
+    uint16_t scale = opacity + 1;
+    int bytes = count * sizeof(CRGB);
+    int words = bytes / sizeof(packed_t);
+    packed_t *d = reinterpret_cast<packed_t *>(dst);
+    const packed_t *s = reinterpret_cast<const packed_t *>(src);
+    switch (mode) {
+        case BLEND_ADD:
+            for (int i = 0; i < words; i++) {
+                d[i] = packed_qadd(d[i], opacity == 255 ? s[i] : packed_scale(s[i], scale));
+            }
+            break;
+        case BLEND_ALPHA:
+            for (int i = 0; i < words; i++) {
+                d[i] = packed_lerp(d[i], s[i], scale);
+            }
+            break;
+        case BLEND_MAX:
+            for (int i = 0; i < words; i++) {
+                d[i] = packed_max(d[i], opacity == 255 ? s[i] : packed_scale(s[i], scale));
+            }
+            break;
+        case BLEND_MULTIPLY: {
+            // 各通道乘数不同, 无法在一个字内并行, 按字节展开
+            uint8_t *db = reinterpret_cast<uint8_t *>(d);
+            const uint8_t *sb = reinterpret_cast<const uint8_t *>(s);
+            for (int i = 0; i < words * 4; i += 4) {
+                db[i + 0] = db[i + 0] * (sb[i + 0] + 1) >> 8;
+                db[i + 1] = db[i + 1] * (sb[i + 1] + 1) >> 8;
+                db[i + 2] = db[i + 2] * (sb[i + 2] + 1) >> 8;
+                db[i + 3] = db[i + 3] * (sb[i + 3] + 1) >> 8;
+            }
+            break;
+        }
+        case BLEND_MASK:
+            for (int i = 0; i < words; i++) {
+                d[i] = packed_mask(d[i], s[i]);
+            }
+            break;
+        default:
+            return;
+    }
+    uint8_t *db = reinterpret_cast<uint8_t *>(dst);
+    const uint8_t *sb = reinterpret_cast<const uint8_t *>(src);
+    for (int i = words * sizeof(packed_t); i < bytes; i++) {
+        db[i] = channel_blend(db[i], sb[i], mode, scale);
+    }
+}
+
+/**
+ * @brief Hash a frame to detect whether it differs from the last pushed one
+ *
+ * @param data frame, must be 4-byte aligned
+ * @param count number of LEDs
+ * @return uint32_t FNV-1a hash over packed words
+ */
+inline uint32_t hash_frame(const CRGB *data, int count) {
+    int bytes = count * sizeof(CRGB);
+    int words = bytes / sizeof(packed_t);
+    const packed_t *p = reinterpret_cast<const packed_t *>(data);
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < words; i++) {
+        hash = (hash ^ p[i]) * 16777619u;
+    }
+    const uint8_t *b = reinterpret_cast<const uint8_t *>(data);
+    for (int i = words * sizeof(packed_t); i < bytes; i++) {
+        hash = (hash ^ b[i]) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Counters of rendered and pushed frames
+ *
+ * A changed frame is pushed only when its hash differs from the last pushed
+ * one, so effects that redraw the same picture do not refresh the LEDs.
+ */
+struct FrameStats {
+    uint32_t rendered; // 灯效产生变化的帧数
+    uint32_t pushed;   // 实际刷新到灯珠的帧数
+    uint32_t hash;     // 最后一次刷新的帧的哈希
+    uint32_t frame;    // 最后一次渲染时的帧序号
+    bool ready;        // 后台帧已渲染完成, 等待输出
+
+    // 记录一帧有变化的渲染, 与上一次刷新的帧相同则无需再次刷新
+    void render(uint32_t frameHash) {
+        rendered++;
+        if (frameHash != hash) {
+            hash = frameHash;
+            ready = true;
+        }
+    }
+
+    // 取出等待输出的帧, 没有则返回 false
+    bool push() {
+        if (!ready) {
+            return false;
+        }
+        ready = false;
+        pushed++;
+        return true;
+    }
+};
+
+/**
+ * @brief Linear interpolate two frames into a destination frame
+ *
+ * @param dst destination frame, must be 4-byte aligned
+ * @param a frame at alpha 0, must be 4-byte aligned
+ * @param b frame at alpha 256, must be 4-byte aligned
+ * @param count number of LEDs
+ * @param alpha weight of frame b (0-256)
+ */
+inline void lerp_frame(CRGB *dst, const CRGB *a, const CRGB *b, int count, uint16_t alpha) {
+    int bytes = count * sizeof(CRGB);
+    int words = bytes / sizeof(packed_t);
+    packed_t *d = reinterpret_cast<packed_t *>(dst);
+    const packed_t *pa = reinterpret_cast<const packed_t *>(a);
+    const packed_t *pb = reinterpret_cast<const packed_t *>(b);
+    for (int i = 0; i < words; i++) {
+        d[i] = packed_lerp(pa[i], pb[i], alpha);
+    }
+    uint8_t *db = reinterpret_cast<uint8_t *>(dst);
+    const uint8_t *ab = reinterpret_cast<const uint8_t *>(a);
+    const uint8_t *bb = reinterpret_cast<const uint8_t *>(b);
+    for (int i = words * sizeof(packed_t); i < bytes; i++) {
+        db[i] = (ab[i] * (256 - alpha) >> 8) + (bb[i] * alpha >> 8);
+    }
+}
+
+// 压缩格式的帧按块展开为 CRGB 后用上面的函数处理, 再压缩回去
+static const int PACKED_CHUNK = 16;
+
+template <typename Format>
+void blend_frame(PackedPixels<Format> dst, PackedPixels<Format> src, int count, BlendMode mode, uint8_t opacity) {
+    alignas(4) CRGB d[PACKED_CHUNK];
+    alignas(4) CRGB s[PACKED_CHUNK];
+    for (int i = 0; i < count; i += PACKED_CHUNK) {
+        int n = std::min(PACKED_CHUNK, count - i);
+        copy_pixels(d, dst + i, n);
+        copy_pixels(s, src + i, n);
+        blend_frame(d, s, n, mode, opacity);
+        copy_pixels(dst + i, d, n);
+    }
+}
+
+template <typename Format>
+uint32_t hash_frame(PackedPixels<Format> data, int count) {
+    const uint8_t *b = reinterpret_cast<const uint8_t *>(data.raw());
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < count * sizeof(typename Format::pixel_type); i++) {
+        hash = (hash ^ b[i]) * 16777619u;
+    }
+    return hash;
+}
+
+template <typename Format>
+void lerp_frame(PackedPixels<Format> dst, PackedPixels<Format> a, PackedPixels<Format> b, int count,
+                uint16_t alpha) {
+    alignas(4) CRGB ca[PACKED_CHUNK];
+    alignas(4) CRGB cb[PACKED_CHUNK];
+    for (int i = 0; i < count; i += PACKED_CHUNK) {
+        int n = std::min(PACKED_CHUNK, count - i);
+        copy_pixels(ca, a + i, n);
+        copy_pixels(cb, b + i, n);
+        lerp_frame(ca, ca, cb, n, alpha);
+        copy_pixels(dst + i, ca, n);
+    }
+}
+
+/**
+ * @brief Overlay effect rendered into its own frame
+ */
+template <typename Light>
+struct Layer {
+    Effect<Light> effect;
+    std::unique_ptr<Light> frame; // 图层启用时分配
+    BlendMode mode;
+    uint8_t opacity;
+};
+
+/**
+ * @brief Stack of overlay layers composited on top of the base effect
+ *
+ * While no layer is active the base effect renders straight into the output
+ * and the compositor costs nothing, not even memory: the frames of the layers
+ * and the scratch frame of the base effect are allocated when a layer is set
+ * and freed when it is cleared. Once a layer is active the base effect renders
+ * into the scratch frame and every changed frame is rebuilt from it.
+ */
+template <typename Light, int N>
+class Compositor {
+private:
+    std::unique_ptr<Light> base; // 有图层时分配
+    Layer<Light> layers[N];
+    int activeCount;
+    bool dirty; // 图层被移除, 下一帧需要重新合成
+
+    static void copy(Light &dst, Light &src) {
+        copy_pixels(dst.data(), src.data(), src.count());
+    }
+
+public:
+    Compositor() : activeCount(0), dirty(false) {}
+
+    static constexpr int size() {
+        return N;
+    }
+
+    bool active() const {
+        return activeCount > 0;
+    }
+
+    Layer<Light>& at(int i) {
+        return layers[i];
+    }
+
+    // 底层灯效的渲染目标
+    Light& target(Light &out) {
+        return active() ? *base : out;
+    }
+
+    /**
+     * @brief Start an effect on a layer, replacing its current effect
+     *
+     * @param out output frame, currently drawn by the base effect
+     * @param i layer index
+     * @param effect effect of the layer
+     * @param mode blend mode
+     * @param opacity opacity of the layer (0-255)
+     * @return false if there is not enough memory for the frames
+     */
+    bool set(Light &out, int i, Effect<Light> &&effect, BlendMode mode, uint8_t opacity) {
+        Layer<Light> &layer = layers[i];
+        if (layer.effect.empty()) {
+            std::unique_ptr<Light> frame(new (std::nothrow) Light());
+            if (!frame) {
+                return false;
+            }
+            if (!active()) {
+                base.reset(new (std::nothrow) Light());
+                if (!base) {
+                    return false;
+                }
+                copy(*base, out); // 保留底层灯效已绘制的内容
+            }
+            layer.frame = std::move(frame);
+            activeCount++;
+        }
+        layer.effect = std::move(effect);
+        layer.mode = mode;
+        layer.opacity = opacity;
+        fill_solid(layer.frame->data(), layer.frame->count(), CRGB::Black);
+        return true;
+    }
+
+    // 移除后下一次 compose 返回 true 以刷新画面, 返回 false 表示图层未启用
+    bool clear(Light &out, int i) {
+        if (layers[i].effect.empty()) {
+            return false;
+        }
+        layers[i].effect = Effect<Light>();
+        layers[i].frame.reset();
+        if (--activeCount == 0) {
+            copy(out, *base);
+            base.reset();
+        }
+        dirty = true;
+        return true;
+    }
+
+    /**
+     * @brief Update all layers and composite them into the output
+     *
+     * @param out output frame
+     * @param baseChanged whether the base effect changed this frame
+     * @param deltaTime time since last frame in microseconds
+     * @return true if the output changed
+     */
+    bool compose(Light &out, bool baseChanged, uint32_t deltaTime) {
+        bool changed = baseChanged || dirty;
+        dirty = false;
+        if (!active()) {
+            return changed;
+        }
+        for (int i = 0; i < N; i++) {
+            if (!layers[i].effect.empty()) {
+                changed |= layers[i].effect.update(*layers[i].frame, deltaTime);
+            }
+        }
+        if (changed) {
+            copy(out, *base);
+            for (int i = 0; i < N; i++) {
+                if (!layers[i].effect.empty()) {
+                    blend_frame(out.data(), layers[i].frame->data(), out.count(),
+                                layers[i].mode, layers[i].opacity);
+                }
+            }
+        }
+        return changed;
+    }
+
+    void writeToJSON(JsonArray &array) const {
+        for (int i = 0; i < N; i++) {
+            if (!layers[i].effect.empty()) {
+                JsonObject obj = array.createNestedObject();
+                obj["index"] = i;
+                obj["mode"] = effect2str(layers[i].effect.type());
+                obj["blend"] = blend2str(layers[i].mode);
+                obj["opacity"] = layers[i].opacity;
+            }
+        }
+    }
+};
+
+#define SEGMENT_NAME_SIZE 12 // 分段名称的最大长度, 含结尾的 '\0'
+
+struct Segment {
+    char name[SEGMENT_NAME_SIZE];
+    uint16_t start;
+    uint16_t length;
+    uint8_t brightness;
+    bool dirty; // 需要重新输出到前台缓冲
+    Effect<LightSegment> effect;
+};
+
+/**
+ * @brief Independent zones on one light, each with its own effect
+ *
+ * Segment effects draw unscaled into their own range of a shared scratch
+ * frame, since ranges never overlap. The scratch frame is allocated with the
+ * first segment and freed with the last one. The ranges are copied, scaled by the
+ * segment brightness, over the output frame after it is swapped to the front
+ * buffer, so the base effect keeps its own frame and the cost of a frame
+ * only depends on the LEDs covered by active segments.
+ */
+template <typename Light, int N>
+class Segments {
+private:
+    std::unique_ptr<CRGB[]> scratch; // 有分段时分配
+    Segment segments[N];
+    int activeCount;
+
+    bool overlaps(int i, int start, int length) const {
+        for (int j = 0; j < N; j++) {
+            const Segment &s = segments[j];
+            if (j != i && !s.effect.empty() && start < s.start + s.length && s.start < start + length) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+public:
+    Segments() : activeCount(0) {}
+
+    static constexpr int size() {
+        return N;
+    }
+
+    bool active() const {
+        return activeCount > 0;
+    }
+
+    Segment& at(int i) {
+        return segments[i];
+    }
+
+    /**
+     * @brief Start an effect on a range of LEDs
+     *
+     * @param light light the segment belongs to
+     * @param i segment index
+     * @param name segment name, truncated to SEGMENT_NAME_SIZE - 1 characters
+     * @param start first LED of the range
+     * @param length number of LEDs in the range
+     * @param effect effect of the segment
+     * @return false if the range is out of the light or overlaps another segment,
+     *         or there is not enough memory for the scratch frame
+     */
+    bool set(Light &light, int i, const char *name, int start, int length, Effect<LightSegment> &&effect) {
+        if (start < 0 || length <= 0 || start + length > light.count() || overlaps(i, start, length)) {
+            return false;
+        }
+        if (!active()) {
+            scratch.reset(new (std::nothrow) CRGB[LightCapacity<Light>::value]);
+            if (!scratch) {
+                return false;
+            }
+        }
+        Segment &s = segments[i];
+        if (s.effect.empty()) {
+            s.brightness = 255;
+            activeCount++;
+        }
+        strncpy(s.name, name, SEGMENT_NAME_SIZE - 1);
+        s.name[SEGMENT_NAME_SIZE - 1] = '\0';
+        s.start = start;
+        s.length = length;
+        s.effect = std::move(effect);
+        s.dirty = true;
+        fill_solid(scratch.get() + start, length, CRGB::Black);
+        return true;
+    }
+
+    void setBrightness(int i, uint8_t brightness) {
+        segments[i].brightness = brightness;
+        segments[i].dirty = true;
+    }
+
+    // 关闭后该范围恢复显示底层灯效, 返回 false 表示分段未启用
+    bool clear(int i) {
+        if (segments[i].effect.empty()) {
+            return false;
+        }
+        segments[i].effect = Effect<LightSegment>();
+        if (--activeCount == 0) {
+            scratch.reset();
+        }
+        return true;
+    }
+
+    /**
+     * @brief Update the effects of all active segments
+     *
+     * @param deltaTime time since last frame in microseconds
+     * @return true if any segment needs to be output again
+     */
+    bool update(uint32_t deltaTime) {
+        bool changed = false;
+        for (Segment &s : segments) {
+            if (!s.effect.empty()) {
+                LightSegment view(scratch.get() + s.start, s.length);
+                s.dirty |= s.effect.update(view, deltaTime);
+                changed |= s.dirty;
+            }
+        }
+        return changed;
+    }
+
+    /**
+     * @brief Draw all active segments over a frame about to be shown
+     *
+     * @param light light the segments belong to, maps the ranges to the outputs
+     * @param out front buffer, overwritten by the base frame on every swap
+     */
+    void overlay(const Light &light, CRGB *out) {
+        for (Segment &s : segments) {
+            if (!s.effect.empty()) {
+                copy_to_output(light, out, scratch.get(), s.start, s.length, s.brightness);
+                s.dirty = false;
+            }
+        }
+    }
+
+    void writeToJSON(JsonArray &array) const {
+        for (int i = 0; i < N; i++) {
+            const Segment &s = segments[i];
+            if (!s.effect.empty()) {
+                JsonObject obj = array.createNestedObject();
+                obj["index"] = i;
+                obj["name"] = s.name;
+                obj["start"] = s.start;
+                obj["length"] = s.length;
+                obj["brightness"] = s.brightness;
+                obj["mode"] = effect2str(s.effect.type());
+            }
+        }
+    }
+};
+
+/**
+ * @brief Crossfade from the outgoing effect to the incoming one
+ *
+ * Both effects stay alive for the duration of the transition and render into
+ * their own frames, which are interpolated into the output. The memory cost
+ * is bounded to the two frames and the outgoing effect, and the frames are
+ * only allocated while a transition is running.
+ */
+template <typename Light>
+class Transition {
+private:
+    Effect<Light> from;
+    std::unique_ptr<Light> fromFrame; // 过渡期间分配
+    std::unique_ptr<Light> toFrame;
+    uint32_t currentTime; // us
+    uint32_t duration;    // us
+
+    void finish() {
+        from = Effect<Light>();
+        fromFrame.reset();
+        toFrame.reset();
+    }
+
+public:
+    Transition() : currentTime(0), duration(0) {}
+
+    bool active() const {
+        return !from.empty();
+    }
+
+    // 新灯效的渲染目标
+    Light& target(Light &out) {
+        return active() ? *toFrame : out;
+    }
+
+    /**
+     * @brief Replace the current effect, fading out the old one
+     *
+     * @param current current effect, replaced by the new effect
+     * @param effect new effect
+     * @param out frame currently rendered by the current effect
+     * @param duration transition duration in milliseconds, 0 to switch instantly
+     *                 (also when there is not enough memory for the frames)
+     */
+    void start(Effect<Light> &current, Effect<Light> &&effect, Light &out, uint32_t duration) {
+        if (duration > 0 && !active()) {
+            fromFrame.reset(new (std::nothrow) Light());
+            toFrame.reset(new (std::nothrow) Light());
+        }
+        if (duration == 0 || !fromFrame || !toFrame) {
+            current = std::move(effect);
+            finish();
+            return;
+        }
+        // 两帧都从当前画面开始, 只绘制一次的灯效也能正确过渡
+        copy_pixels(fromFrame->data(), out.data(), out.count());
+        copy_pixels(toFrame->data(), out.data(), out.count());
+        from = std::move(current);
+        current = std::move(effect);
+        this->currentTime = 0;
+        this->duration = duration * 1000;
+    }
+
+    /**
+     * @brief Update the current effect, blending it with the outgoing effect
+     *
+     * @param current current effect
+     * @param out output frame
+     * @param deltaTime time since last frame in microseconds
+     * @return true if the output changed
+     */
+    bool update(Effect<Light> &current, Light &out, uint32_t deltaTime) {
+        if (!active()) {
+            return current.update(out, deltaTime);
+        }
+        from.update(*fromFrame, deltaTime);
+        current.update(*toFrame, deltaTime);
+        currentTime += deltaTime;
+        if (currentTime >= duration) {
+            copy_pixels(out.data(), toFrame->data(), out.count());
+            finish();
+            return true;
+        }
+        uint16_t alpha = ((uint64_t) currentTime << 8) / duration;
+        lerp_frame(out.data(), fromFrame->data(), toFrame->data(), out.count(), alpha);
+        return true;
+    }
+};
+
+#endif // __LIGHTCOMPOSITOR_HPP__
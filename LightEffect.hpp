@@ -5,10 +5,13 @@
 #include <LittleFS.h>
 #include <FastLED.h>
 #include <ArduinoJson.h>
-#include <functional>
+#include <new>
+#include <type_traits>
 
+#include "Animation.hpp"
 #include "Light.hpp"
-#include "any.h"
+#include "Profiler.hpp"
+#include "Waveform.hpp"
 #include "utils.h"
 
 enum EffectType {
@@ -23,6 +26,8 @@ enum EffectType {
     CUSTOM,      // 上位机控制
     EFFECT_TYPE_COUNT
 };
+static_assert(PERF_EFFECT + EFFECT_TYPE_COUNT <= PERF_STAGE_COUNT,
+                "Not enough profiler stages for effects!");
 
 /**
  * @brief Get light effect enum from name
@@ -36,62 +41,105 @@ EffectType str2effect(const char *str);
  * @brief Get name from light effect enum
  * 
  * @param effect effect enum
- * @return const char* effect name
+ * @return const __FlashStringHelper* effect name, stored in flash
  */
-const char* effect2str(EffectType effect);
+const __FlashStringHelper* effect2str(EffectType effect);
 
-extern const uint16_t &fps;
+/**
+ * @brief Get argument description from light effect enum
+ *
+ * @param effect effect enum
+ * @return const __FlashStringHelper* comma separated argument names, stored in flash
+ */
+const __FlashStringHelper* effect2args(EffectType effect);
 
-template <typename Light>
-class Effect {
-private:
-    std::any _impl;
-    std::function<EffectType()> _type;
-    std::function<bool(Light &, uint32_t)> _update;
-    std::function<void(JsonDocument &)> _writeToJSON;
+/**
+ * @brief Advance the clock of a hue animation and get the hue at that time
+ *
+ * The hue changes by delta every 1/60 second regardless of the refresh rate.
+ *
+ * @param currentTime clock of the animation in microseconds, advanced in place
+ * @param deltaTime time since last frame in microseconds
+ * @param delta hue change per 1/60 second
+ * @return uint8_t hue at the current time
+ */
+inline uint8_t hue_at(uint32_t &currentTime, uint32_t deltaTime, int8_t delta) {
+    // 任意整数 delta 下色相在 256 * 3 / 60 秒后都回到起点, 时钟按此取模不会跳变
+    const uint32_t HUE_PERIOD = 12800000;
+    currentTime = (currentTime + deltaTime) % HUE_PERIOD;
+    return (int64_t) currentTime * 6 * delta / 100000;
+}
 
-public:
-    Effect() noexcept {}
+// hue_at 的逆运算, 返回 delta 下得到 hue 的时钟, 修改 delta 时用于保持色相连续
+inline uint32_t hue_time(uint8_t hue, int8_t delta) {
+    uint32_t steps = delta > 0 ? hue : (256 - hue) % 256;
+    uint32_t speed = 6 * abs(delta);
+    return (steps * 100000 + speed - 1) / speed;
+}
 
-    template <typename T>
-    Effect(T &&impl) : _impl(std::forward<T>(impl)) {
-        _type = [this]() -> EffectType {
-            return std::any_cast<T&>(_impl).type();
-        };
-        _update = [this](Light &light, uint32_t deltaTime) -> bool {
-            return std::any_cast<T&>(_impl).update(light, deltaTime);
-        };
-        _writeToJSON = [this](JsonDocument &json) {
-            std::any_cast<T&>(_impl).writeToJSON(json);
-        };
+// 解析 #RRGGBB 格式的颜色参数
+inline bool parse_param(const char *str, CRGB &value) {
+    if (str[0] != '#' || strlen(str) != 7 || strspn(str + 1, "0123456789abcdefABCDEF") != 6) {
+        return false;
     }
+    value = CRGB(str2hex(str));
+    return true;
+}
 
-    template <typename T>
-    Effect<Light>& operator=(T &&impl) {
-        ::new(this) Effect<Light>(std::forward<T>(impl));
-        return *this;
-    }
+// 时长参数的上限 (秒), 换算为微秒后亮起和熄灭两段相加仍在 32 位以内
+const float MAX_DURATION = 1800;
 
-    template <typename T>
-    T& as() {
-        return std::any_cast<T&>(_impl);
-    }
+// 时长参数是否有效, 持续时间须为正, 间隔可以为 0, NaN 无效
+inline bool valid_duration(float seconds, bool allowZero = false) {
+    return (allowZero ? seconds >= 0 : seconds > 0) && seconds <= MAX_DURATION;
+}
 
-    EffectType type() const {
-        return _type();
-    }
+// 有效时返回时长, 否则返回默认值
+inline float duration_or(float seconds, float fallback, bool allowZero = false) {
+    return valid_duration(seconds, allowZero) ? seconds : fallback;
+}
 
-    bool update(Light &light, uint32_t deltaTime) {
-        return _update(light, deltaTime);
-    }
+// 秒换算为微秒, 超出范围时截断, 不把越界的浮点数直接转为整数
+inline uint32_t duration_us(float seconds) {
+    return seconds > 0 ? (uint32_t) (std::min(seconds, MAX_DURATION) * 1000000) : 0;
+}
 
-    void writeToJSON(JsonDocument &json) const {
-        json["mode"] = type();
-        _writeToJSON(json);
+/**
+ * @brief Set a field if the parameter name matches and the value is valid
+ *
+ * @param param parameter name
+ * @param value parameter value
+ * @param key name of the field
+ * @param field field to set
+ * @return bool whether the field is set
+ */
+template <typename T>
+bool set_param(const char *param, const char *value, const char *key, T &field) {
+    return strcmp(param, key) == 0 && parse_param(value, field);
+}
+
+// 与 set_param 相同, 但只接受有效的时长
+inline bool set_duration(const char *param, const char *value, const char *key, float &field,
+                         bool allowZero = false) {
+    float seconds;
+    if (strcmp(param, key) != 0 || !parse_param(value, seconds) || !valid_duration(seconds, allowZero)) {
+        return false;
     }
+    field = seconds;
+    return true;
+}
 
-    // defined at the end of the file
-    static Effect<Light> readFromJSON(JsonDocument &json);
+/**
+ * @brief Lifetime counters of light effects, used to detect leaks
+ */
+struct EffectCounters {
+    static uint32_t created;   // 已构造的灯效数
+    static uint32_t destroyed; // 已析构的灯效数
+    static uint16_t openFiles; // 当前打开的动画文件数
+
+    static uint32_t alive() {
+        return created - destroyed;
+    }
 };
 
 class ConstantEffect {
@@ -103,10 +151,18 @@ public:
     ConstantEffect(uint32_t color) :
         updated(false), currentColor(color) {}
 
-    EffectType type() const {
+    static constexpr EffectType type() {
         return CONSTANT;
     }
 
+    static constexpr const char* name() {
+        return "constant";
+    }
+
+    static constexpr const char* args() {
+        return "color";
+    }
+
     template <typename Light>
     bool update(Light &light, uint32_t deltaTime) {
         if (!updated) {
@@ -117,6 +173,14 @@ public:
         return false;
     }
 
+    bool set(const char *param, const char *value) {
+        if (set_param(param, value, "color", currentColor)) {
+            updated = false;
+            return true;
+        }
+        return false;
+    }
+
     void writeToJSON(JsonDocument &json) const {
         json["color"] = rgb2hex(currentColor.r, currentColor.g, currentColor.b);
     }
@@ -125,39 +189,58 @@ public:
         uint32_t color = json["color"];
         return ConstantEffect(color);
     }
+
+    static ConstantEffect fromArgs(int argc, const char *argv[]) {
+        uint32_t color = argc > 0 ? str2hex(argv[0]) : DEFAULT_COLOR;
+        return ConstantEffect(color);
+    }
 };
 
 class BlinkEffect {
 private:
-    uint16_t currentFrame;
+    Waveform wave;
+    int8_t currentState;
     CRGB currentColor;
     float lastTime;
     float interval;
 
 public:
     BlinkEffect(uint32_t color, float lastTime, float interval) :
-        currentFrame(0), currentColor(color), lastTime(lastTime), interval(interval) {}
+        wave(WAVE_SQUARE, duration_us(lastTime), duration_us(interval)),
+        currentState(-1), currentColor(color), lastTime(lastTime), interval(interval) {}
 
-    EffectType type() const {
+    static constexpr EffectType type() {
         return BLINK;
     }
 
+    static constexpr const char* name() {
+        return "blink";
+    }
+
+    static constexpr const char* args() {
+        return "color,lastTime,interval";
+    }
+
     template <typename Light>
     bool update(Light &light, uint32_t deltaTime) {
-        int lastTime = fps * this->lastTime;
-        int interval = fps * this->interval;
-        bool needUpdate = false;
-        if (currentFrame == 0) {
-            fill_solid(light.data(), light.count(), currentColor);
-            needUpdate = true;
-        } else if (currentFrame == lastTime) {
-            fill_solid(light.data(), light.count(), CRGB::Black);
-            needUpdate = true;
+        int8_t state = wave.advance(deltaTime) > 0;
+        if (state == currentState) {
+            return false;
         }
-        if (++currentFrame >= lastTime + interval) {
-            currentFrame = 0;
+        fill_solid(light.data(), light.count(), state ? currentColor : CRGB(CRGB::Black));
+        currentState = state;
+        return true;
+    }
+
+    bool set(const char *param, const char *value) {
+        if (set_param(param, value, "color", currentColor) ||
+            set_duration(param, value, "lastTime", lastTime) ||
+            set_duration(param, value, "interval", interval, true)) {
+            wave.setTiming(duration_us(lastTime), duration_us(interval));
+            currentState = -1; // 下一帧重绘, 时钟不变
+            return true;
         }
-        return needUpdate;
+        return false;
     }
 
     void writeToJSON(JsonDocument &json) const {
@@ -168,44 +251,66 @@ public:
 
     static BlinkEffect readFromJSON(JsonDocument &json) {
         uint32_t color = json["color"];
-        float lastTime = json["lastTime"];
-        float interval = json["interval"];
+        float lastTime = duration_or(json["lastTime"], 1.0);
+        float interval = duration_or(json["interval"], 1.0, true);
+        return BlinkEffect(color, lastTime, interval);
+    }
+
+    static BlinkEffect fromArgs(int argc, const char *argv[]) {
+        uint32_t color = argc > 0 ? str2hex(argv[0]) : DEFAULT_COLOR;
+        float lastTime = argc > 1 ? duration_or(atof(argv[1]), 1.0) : 1.0;
+        float interval = argc > 2 ? duration_or(atof(argv[2]), 1.0, true) : 1.0;
         return BlinkEffect(color, lastTime, interval);
     }
 };
 
 class BreathEffect {
 private:
-    uint16_t currentFrame;
+    Waveform wave;
+    int16_t currentLevel;
     CRGB currentColor;
     float lastTime;
     float interval;
 
 public:
     BreathEffect(uint32_t color, float lastTime, float interval) :
-        currentFrame(0), currentColor(color), lastTime(lastTime), interval(interval) {}
+        wave(WAVE_PARABOLA, std::max<uint32_t>(duration_us(lastTime), 1), duration_us(interval)),
+        currentLevel(-1), currentColor(color), lastTime(lastTime), interval(interval) {}
 
-    EffectType type() const {
+    static constexpr EffectType type() {
         return BREATH;
     }
 
+    static constexpr const char* name() {
+        return "breath";
+    }
+
+    static constexpr const char* args() {
+        return "color,lastTime,interval";
+    }
+
     template <typename Light>
     bool update(Light &light, uint32_t deltaTime) {
-        int lastTime = fps * this->lastTime;
-        int interval = fps * this->interval;
-        bool needUpdate = false;
-        if (currentFrame <= lastTime) {
-            CRGB rgb = currentColor;
-            double x = (double) currentFrame / lastTime;
-            int scale = -1010 * x * x + 1010 * x;
-            rgb.nscale8(scale);
-            fill_solid(light.data(), light.count(), rgb);
-            needUpdate = true;
-        }
-        if (++currentFrame >= lastTime + interval) {
-            currentFrame = 0;
+        uint8_t level = wave.advance(deltaTime);
+        if (level == currentLevel) { // 间隔期间亮度一直为 0, 无需重绘
+            return false;
+        }
+        CRGB rgb = currentColor;
+        rgb.nscale8(level);
+        fill_solid(light.data(), light.count(), rgb);
+        currentLevel = level;
+        return true;
+    }
+
+    bool set(const char *param, const char *value) {
+        if (set_param(param, value, "color", currentColor) ||
+            set_duration(param, value, "lastTime", lastTime) ||
+            set_duration(param, value, "interval", interval, true)) {
+            wave.setTiming(std::max<uint32_t>(duration_us(lastTime), 1), duration_us(interval));
+            currentLevel = -1;
+            return true;
         }
-        return needUpdate;
+        return false;
     }
 
     void writeToJSON(JsonDocument &json) const {
@@ -216,67 +321,88 @@ public:
 
     static BreathEffect readFromJSON(JsonDocument &json) {
         uint32_t color = json["color"];
-        float lastTime = json["lastTime"];
-        float interval = json["interval"];
+        float lastTime = duration_or(json["lastTime"], 1.0);
+        float interval = duration_or(json["interval"], 0.5, true);
+        return BreathEffect(color, lastTime, interval);
+    }
+
+    static BreathEffect fromArgs(int argc, const char *argv[]) {
+        uint32_t color = argc > 0 ? str2hex(argv[0]) : DEFAULT_COLOR;
+        float lastTime = argc > 1 ? duration_or(atof(argv[1]), 1.0) : 1.0;
+        float interval = argc > 2 ? duration_or(atof(argv[2]), 0.5, true) : 0.5;
         return BreathEffect(color, lastTime, interval);
     }
 };
 
 class ChaseEffect {
 private:
-    uint16_t currentFrame;
+    uint64_t currentTime; // us, 往返一次可能超过 32 位
+    int currentIndex;
     CRGB currentColor;
     uint8_t direction;
     float lastTime;
 
+    // 往返一次共 2 * count 步, 返回当前所在位置, 位置未变化时返回 -1
+    int step(int count, uint32_t deltaTime) {
+        if (count <= 0) {
+            return -1;
+        }
+        uint32_t stepTime = std::max<uint32_t>(duration_us(lastTime), 1);
+        currentTime = (currentTime + deltaTime) % ((uint64_t) stepTime * count * 2);
+        int index = currentTime / stepTime;
+        if (index == currentIndex) {
+            return -1;
+        }
+        currentIndex = index;
+        return index > count - 1 ? count * 2 - 1 - index : index;
+    }
+
 public:
     ChaseEffect(uint32_t color, uint8_t direction, float lastTime) :
-        currentFrame(0), currentColor(color), direction(direction), lastTime(lastTime) {}
+        currentTime(0), currentIndex(-1), currentColor(color), direction(direction), lastTime(lastTime) {}
 
-    EffectType type() const {
+    static constexpr EffectType type() {
         return CHASE;
     }
 
-    template <int COUNT, bool REVERSE>
-    bool update(LightStrip<COUNT, REVERSE> &light, uint32_t deltaTime) {
-        int lastTime = fps * this->lastTime;
-        bool needUpdate = false;
-        if (currentFrame % lastTime == 0) {
-            fill_solid(light.data(), light.count(), CRGB::Black);
-            int index = currentFrame / lastTime;
-            if (index > light.l() * 2 - 1) {
-                currentFrame = 0;
-                index = 0;
-            } else if (index > light.l() - 1) {
-                index = light.l() * 2 - 1 - index;
-            }
-            light.at(index) = currentColor;
-            needUpdate = true;
+    static constexpr const char* name() {
+        return "chase";
+    }
+
+    static constexpr const char* args() {
+        return "color,direction,lastTime";
+    }
+
+    template <typename Light>
+    bool update(Light &light, uint32_t deltaTime) {
+        int index = step(light.slices(), deltaTime);
+        if (index < 0) {
+            return false;
         }
-        ++currentFrame;
-        return needUpdate;
+        CRGB color = currentColor;
+        shade(light, [index, color](int slice) {
+            return slice == index ? color : CRGB(CRGB::Black);
+        });
+        return true;
     }
 
-    template <int ARRANGEMENT, int... COUNT_PER_RING>
-    bool update(LightDisc<ARRANGEMENT, COUNT_PER_RING...> &light, uint32_t deltaTime) {
-        int lastTime = fps * this->lastTime;
-        bool needUpdate = false;
-        if (currentFrame % lastTime == 0) {
-            fill_solid(light.data(), light.count(), CRGB::Black);
-            int index = currentFrame / lastTime;
-            if (index > light.r() * 2 - 1) {
-                currentFrame = 0;
-                index = 0;
-            } else if (index > light.r() - 1) {
-                index = light.r() * 2 - 1 - index;
-            }
-            for (int j = 0; j < light.l(index); j++) {
-                light.at(index, j) = currentColor;
+    bool set(const char *param, const char *value) {
+        if (strcmp(param, "lastTime") == 0) {
+            uint32_t stepTime = std::max<uint32_t>(duration_us(lastTime), 1);
+            if (!set_duration(param, value, "lastTime", lastTime)) {
+                return false;
             }
-            needUpdate = true;
+            // 按新的步长换算时钟, 保持当前位置不变, 整步和余数分开换算以免 64 位乘法溢出
+            uint32_t newStepTime = std::max<uint32_t>(duration_us(lastTime), 1);
+            currentTime = currentTime / stepTime * newStepTime + currentTime % stepTime * newStepTime / stepTime;
+            return true;
         }
-        ++currentFrame;
-        return needUpdate;
+        if (set_param(param, value, "color", currentColor) ||
+            set_param(param, value, "direction", direction)) {
+            currentIndex = -1;
+            return true;
+        }
+        return false;
     }
 
     void writeToJSON(JsonDocument &json) const {
@@ -288,31 +414,61 @@ public:
     static ChaseEffect readFromJSON(JsonDocument &json) {
         uint32_t color = json["color"];
         uint8_t direction = json["direction"];
-        float lastTime = json["lastTime"];
+        float lastTime = duration_or(json["lastTime"], 0.2);
+        return ChaseEffect(color, direction, lastTime);
+    }
+
+    static ChaseEffect fromArgs(int argc, const char *argv[]) {
+        uint32_t color = argc > 0 ? str2hex(argv[0]) : DEFAULT_COLOR;
+        uint8_t direction = argc > 1 ? atoi(argv[1]) : 0;
+        float lastTime = argc > 2 ? duration_or(atof(argv[2]), 0.2) : 0.2;
         return ChaseEffect(color, direction, lastTime);
     }
 };
 
 class RainbowEffect {
 private:
-    uint8_t currentHue;
+    uint32_t currentTime; // us
+    int16_t currentHue;
     int8_t delta;
 
 public:
     RainbowEffect(int8_t delta) :
-        currentHue(0), delta(delta) {}
+        currentTime(0), currentHue(-1), delta(delta) {}
 
-    EffectType type() const {
+    static constexpr EffectType type() {
         return RAINBOW;
     }
 
+    static constexpr const char* name() {
+        return "rainbow";
+    }
+
+    static constexpr const char* args() {
+        return "delta";
+    }
+
     template <typename Light>
     bool update(Light &light, uint32_t deltaTime) {
-        CHSV hsv(currentHue, 255, 240);
+        uint8_t hue = hue_at(currentTime, deltaTime, delta);
+        if (hue == currentHue) {
+            return false;
+        }
+        currentHue = hue;
+        CHSV hsv(hue, 255, 240);
         CRGB rgb;
         hsv2rgb_rainbow(hsv, rgb);
         fill_solid(light.data(), light.count(), rgb);
-        currentHue += delta;
+        return true;
+    }
+
+    bool set(const char *param, const char *value) {
+        if (!set_param(param, value, "delta", delta)) {
+            return false;
+        }
+        if (delta != 0 && currentHue >= 0) {
+            currentTime = hue_time(currentHue, delta);
+        }
         return true;
     }
 
@@ -324,40 +480,82 @@ public:
         uint8_t delta = json["delta"];
         return RainbowEffect(delta);
     }
+
+    static RainbowEffect fromArgs(int argc, const char *argv[]) {
+        int8_t delta = argc > 0 ? atoi(argv[0]) : 1;
+        return RainbowEffect(delta);
+    }
 };
 
 class StreamEffect {
 private:
-    uint8_t currentHue;
+    uint32_t currentTime; // us
+    int16_t currentHue;
     uint8_t direction;
     int8_t delta;
 
+    // 返回当前色相, 色相未变化时返回 -1
+    int16_t step(uint32_t deltaTime) {
+        uint8_t hue = hue_at(currentTime, deltaTime, delta);
+        if (hue == currentHue) {
+            return -1;
+        }
+        currentHue = hue;
+        return hue;
+    }
+
 public:
     StreamEffect(uint8_t direction, int8_t delta) :
-        currentHue(0), direction(direction), delta(delta) {}
+        currentTime(0), currentHue(-1), direction(direction), delta(delta) {}
 
-    EffectType type() const {
+    static constexpr EffectType type() {
         return STREAM;
     }
 
-    template <int COUNT, bool REVERSE>
-    bool update(LightStrip<COUNT, REVERSE> &light, uint32_t deltaTime) {
-        fill_rainbow(light.data(), light.count(), currentHue);
-        currentHue += delta;
+    static constexpr const char* name() {
+        return "stream";
+    }
+
+    static constexpr const char* args() {
+        return "direction,delta";
+    }
+
+    // direction 为 0 时按切片渐变, 1 时沿 x 轴 (圆盘为圆周) 渐变, 2 时沿对角线 (圆盘为螺旋) 渐变
+    template <typename Light>
+    bool update(Light &light, uint32_t deltaTime) {
+        int16_t hue = step(deltaTime);
+        if (hue < 0) {
+            return false;
+        }
+        if (direction == 0) {
+            shade(light, [hue](int slice) {
+                CRGB rgb; // 与 fill_rainbow 相同, 每个切片色相增加 5
+                hsv2rgb_rainbow(CHSV(hue + slice * 5, 240, 255), rgb);
+                return rgb;
+            });
+            return true;
+        }
+        bool diagonal = direction == 2;
+        light.shadePixels([hue, diagonal](LightPoint p) {
+            CRGB rgb;
+            hsv2rgb_rainbow(CHSV(hue + p.x + (diagonal ? p.y + p.z : 0), 240, 255), rgb);
+            return rgb;
+        });
         return true;
     }
 
-    template <int ARRANGEMENT, int... COUNT_PER_RING>
-    bool update(LightDisc<ARRANGEMENT, COUNT_PER_RING...> &light, uint32_t deltaTime) {
-        CRGB rgb[light.r()];
-        fill_rainbow(rgb, light.r(), currentHue);
-        for (int i = 0; i < light.r(); i++) {
-            for (int j = 0; j < light.l(i); j++) {
-                light.at(i, j) = rgb[i];
+    bool set(const char *param, const char *value) {
+        if (set_param(param, value, "delta", delta)) {
+            if (delta != 0 && currentHue >= 0) {
+                currentTime = hue_time(currentHue, delta);
             }
+            return true;
         }
-        currentHue += delta;
-        return true;
+        if (set_param(param, value, "direction", direction)) {
+            currentHue = -1;
+            return true;
+        }
+        return false;
     }
 
     void writeToJSON(JsonDocument &json) const {
@@ -370,25 +568,40 @@ public:
         uint8_t delta = json["delta"];
         return StreamEffect(direction, delta);
     }
+
+    static StreamEffect fromArgs(int argc, const char *argv[]) {
+        uint8_t direction = argc > 0 ? atoi(argv[0]) : 0;
+        int8_t delta = argc > 1 ? atoi(argv[1]) : 1;
+        return StreamEffect(direction, delta);
+    }
 };
 
 class AnimationEffect {
 private:
     String animName;
     File file;
-    uint16_t currentFrame;
+    std::unique_ptr<AnimPlayer> player; // 二进制动画的播放器, CSV 动画时为空
+    uint32_t currentFrame; // CSV 动画已播放的帧数
+    uint32_t currentTime;  // 距上一帧的时间 (us), 按二进制动画的帧率播放
 
-public:
-    AnimationEffect(const char *animName) :
-        animName(animName), currentFrame(0) {
-        if (strlen(animName) > 0) {
+    void open() {
+        if (animName.length() > 0) {
             String path = String("/animations/") + animName;
             file = LittleFS.open(path, "r");
             if (!file.isFile()) {
                 file.close();
             }
         }
+        player.reset();
         if (file) {
+            AnimHeader header;
+            if (read_anim_header(file, header)) {
+                player.reset(new AnimPlayer(file, header));
+                if (!player->begin()) {
+                    player.reset();
+                }
+            }
+            EffectCounters::openFiles++;
             Serial.print(F("Start to play animation: "));
         } else {
             Serial.print(F("Failed to open animation: "));
@@ -396,24 +609,92 @@ public:
         Serial.println(animName);
     }
 
-    ~AnimationEffect() {
+    void close() {
+        player.reset();
         if (file) {
             file.close();
+            EffectCounters::openFiles--;
             Serial.println(F("Stop playing animation"));
         }
     }
 
-    EffectType type() const {
+    /**
+     * @brief Play a binary animation
+     *
+     * Frames that fall between two refreshes are skipped. The player has
+     * usually decoded the frame ahead of time, so this is a copy.
+     */
+    template <typename Light>
+    bool updateBinary(Light &light, uint32_t deltaTime) {
+        uint32_t steps = 1; // 本次前进的帧数, 大于 1 时跳过中间的帧
+        if (player->fps() > 0) {
+            uint32_t interval = 1000000 / player->fps();
+            currentTime += deltaTime;
+            if (currentTime < interval) {
+                return false;
+            }
+            steps = currentTime / interval;
+            currentTime %= interval;
+        }
+#ifdef ENABLE_DEBUG
+        Serial.printf_P(PSTR("Playing anim frame: %u\n"), player->frame());
+#endif
+        if (!player->play(steps, light.data(), light.count())) {
+            if (player->frameCount() > 0) {
+                Serial.println(F("Truncated animation, replay"));
+            }
+            return false;
+        }
+        return true;
+    }
+
+public:
+    AnimationEffect(const char *animName, uint32_t frame = 0, uint32_t loopStart = 0, uint32_t loopEnd = 0,
+                    bool reverse = false) :
+        animName(animName), currentFrame(0), currentTime(0) {
+        open();
+        if (player) {
+            player->setLoop(loopStart, loopEnd);
+            player->setReverse(reverse);
+            player->seek(frame); // 从保存的位置继续播放
+        }
+    }
+
+    AnimationEffect(AnimationEffect &&other) :
+        animName(std::move(other.animName)), file(other.file), player(std::move(other.player)),
+        currentFrame(other.currentFrame), currentTime(other.currentTime) {
+        other.file = File(); // 文件句柄的所有权转移给新对象
+    }
+
+    AnimationEffect(const AnimationEffect &) = delete;
+    AnimationEffect& operator=(const AnimationEffect &) = delete;
+
+    ~AnimationEffect() {
+        close();
+    }
+
+    static constexpr EffectType type() {
         return ANIMATION;
     }
 
+    static constexpr const char* name() {
+        return "animation";
+    }
+
+    static constexpr const char* args() {
+        return "animName";
+    }
+
     template <typename Light>
     bool update(Light &light, uint32_t deltaTime) {
         if (!file) {
             return false;
         }
+        if (player) {
+            return updateBinary(light, deltaTime);
+        }
 #ifdef ENABLE_DEBUG
-        Serial.printf_P(PSTR("Playing anim frame: %d\n"), currentFrame);
+        Serial.printf_P(PSTR("Playing anim frame: %u\n"), currentFrame);
 #endif
         char buffer[8] = "";
         int bufLen = 0;
@@ -430,7 +711,9 @@ public:
             // parse data
             if (c == ',' || c == '\n') {
                 buffer[bufLen] = '\0';
-                if (buffer[0] == '#' && bufLen == 7) {
+                if (index >= light.count()) { // 忽略超出灯珠数的元素
+                    bufLen = 0;
+                } else if (buffer[0] == '#' && bufLen == 7) {
                     buffer[bufLen] = '\0';
                     light.data()[index++] = str2hex(buffer);
                     bufLen = 0;
@@ -452,83 +735,142 @@ public:
         return true;
     }
 
+    // 二进制动画可跳转, 播放位置可随配置保存
+    bool seekable() const {
+        return (bool) player;
+    }
+
+    bool set(const char *param, const char *value) {
+        if (set_param(param, value, "animName", animName)) {
+            close();
+            currentFrame = 0;
+            currentTime = 0;
+            open();
+            return true;
+        }
+        if (!player) { // CSV 动画只能从头依次播放
+            return false;
+        }
+        uint32_t frame;
+        if (set_param(param, value, "frame", frame)) {
+            if (!player->seek(frame)) {
+                return false;
+            }
+            currentTime = player->fps() > 0 ? 1000000 / player->fps() : 0; // 下次刷新立即显示
+            return true;
+        }
+        uint32_t loopStart, loopEnd;
+        if (set_param(param, value, "loopStart", loopStart)) {
+            player->setLoop(loopStart, player->loopEnd());
+            return true;
+        }
+        if (set_param(param, value, "loopEnd", loopEnd)) {
+            player->setLoop(player->loopStart(), loopEnd);
+            return true;
+        }
+        bool reverse;
+        if (set_param(param, value, "reverse", reverse)) {
+            player->setReverse(reverse);
+            return true;
+        }
+        return false;
+    }
+
     void writeToJSON(JsonDocument &json) const {
         json["animName"] = animName;
+        json["frame"] = player ? player->frame() : currentFrame;
+        json["frameCount"] = player ? player->frameCount() : 0;
+        json["loopStart"] = player ? player->loopStart() : 0;
+        json["loopEnd"] = player ? player->loopEnd() : 0;
+        json["reverse"] = player ? player->reverse() : false;
     }
 
     static AnimationEffect readFromJSON(JsonDocument &json) {
         const char *animName = json["animName"];
-        return AnimationEffect(animName);
+        uint32_t frame = json["frame"];
+        uint32_t loopStart = json["loopStart"];
+        uint32_t loopEnd = json["loopEnd"];
+        bool reverse = json["reverse"];
+        return AnimationEffect(animName, frame, loopStart, loopEnd, reverse);
+    }
+
+    static AnimationEffect fromArgs(int argc, const char *argv[]) {
+        const char *name = argc > 0 ? argv[0] : "";
+        return AnimationEffect(name);
     }
 };
 
 class MusicEffect {
 private:
     uint8_t soundMode; // 0-电平模式 1-频谱模式
-    uint8_t currentHue;
+    uint32_t currentTime; // us
+    int16_t currentHue;
+    int16_t currentCount; // 上一帧点亮的灯珠或灯环数
     double currentVolume; // Must be 0~1
 
+    // 音量对应的点亮数量和色相都没变时无需重绘
+    bool step(int count, uint8_t hue) {
+        if (count == currentCount && (soundMode == 0 || hue == currentHue)) {
+            return false;
+        }
+        currentCount = count;
+        currentHue = hue;
+        return true;
+    }
+
 public:
     MusicEffect(uint8_t mode) :
-        soundMode(mode), currentHue(0), currentVolume(0.0) {}
+        soundMode(mode), currentTime(0), currentHue(-1), currentCount(-1), currentVolume(0.0) {}
 
     void setVolume(double volume) {
         currentVolume = volume;
     }
 
-    EffectType type() const {
+    static constexpr EffectType type() {
         return MUSIC;
     }
 
-    template <int COUNT, bool REVERSE>
-    bool update(LightStrip<COUNT, REVERSE> &light, uint32_t deltaTime) {
+    static constexpr const char* name() {
+        return "music";
+    }
+
+    static constexpr const char* args() {
+        return "soundMode";
+    }
+
+    template <typename Light>
+    bool update(Light &light, uint32_t deltaTime) {
+        int slices = light.slices();
+        int count = soundMode == 0 ? slices * currentVolume : ceil(slices * currentVolume);
+        uint8_t hue = hue_at(currentTime, deltaTime, 1);
+        if (!step(count, hue)) {
+            return false;
+        }
         if (soundMode == 0) {
-            int count = light.l() * currentVolume;
-            fill_solid(light.data(), light.count(), CRGB::Black);
-            if (count > 0) {
-                fill_solid(light.data(), count - 1, CRGB::Green);
-                light.at(count - 1) = CRGB::Red;
-            }
+            // 电平模式, 从第一个切片开始点亮, 最后一个为红色
+            shade(light, [count](int slice) {
+                return slice < count - 1 ? CRGB(CRGB::Green) : slice == count - 1 ? CRGB(CRGB::Red) : CRGB(CRGB::Black);
+            });
         } else {
-            int count = light.l() * currentVolume;
-            CHSV hsv(currentHue++, 255, 240);
+            // 频谱模式, 点亮中间的切片
+            CHSV hsv(hue, 255, 240);
             CRGB rgb;
             hsv2rgb_rainbow(hsv, rgb);
-            fill_solid(light.data(), light.count(), CRGB::Black);
-            fill_solid(light.data() + (light.count() - count) / 2, count, rgb);
+            int begin = (slices - count) / 2;
+            int end = begin + count;
+            shade(light, [begin, end, rgb](int slice) {
+                return slice >= begin && slice < end ? rgb : CRGB(CRGB::Black);
+            });
         }
         return true;
     }
 
-    template <int ARRANGEMENT, int... COUNT_PER_RING>
-    bool update(LightDisc<ARRANGEMENT, COUNT_PER_RING...> &light, uint32_t deltaTime) {
-        if (soundMode == 0) {
-            int r = light.r() * currentVolume;
-            fill_solid(light.data(), light.count(), CRGB::Black);
-            if (r > 0) {
-                for (int i = 0; i < r; i++) {
-                    for (int j = 0; j < light.l(i); j++) {
-                        light.at(i, j) = CRGB::Green;
-                    }
-                }
-                int l = light.l(r - 1);
-                for (int j = 0; j < l; j++) {
-                    light.at(r - 1, j) = CRGB::Red;
-                }
-            }
-        } else {
-            int r = ceil(light.r() * currentVolume);
-            CHSV hsv(currentHue++, 255, 240);
-            CRGB rgb;
-            hsv2rgb_rainbow(hsv, rgb);
-            fill_solid(light.data(), light.count(), CRGB::Black);
-            for (int i = light.r() - r; i < light.r(); i++) {
-                for (int j = 0; j < light.l(i); j++) {
-                    light.at(i, j) = rgb;
-                }
-            }
+    bool set(const char *param, const char *value) {
+        if (set_param(param, value, "soundMode", soundMode)) {
+            currentCount = -1;
+            return true;
         }
-        return true;
+        return false;
     }
 
     void writeToJSON(JsonDocument &json) const {
@@ -539,26 +881,57 @@ public:
         uint8_t soundMode = json["soundMode"];
         return MusicEffect(soundMode);
     }
+
+    static MusicEffect fromArgs(int argc, const char *argv[]) {
+        uint8_t mode = argc > 0 ? atoi(argv[0]) : 1;
+        return MusicEffect(mode);
+    }
 };
 
 class CustomEffect {
 private:
     int index;
+    bool dirty;
 
 public:
-    CustomEffect() : index(0) {}
-
-    int& getIndex() {
-        return index;
+    CustomEffect() : index(0), dirty(false) {}
+
+    /**
+     * @brief Write the next pixel received from the client
+     *
+     * @param light light to write to
+     * @param color color of the pixel
+     */
+    template <typename Light>
+    void push(Light &light, CRGB color) {
+        light.data()[index++] = color;
+        if (index >= light.count()) {
+            index = 0;
+        }
+        dirty = true;
     }
 
-    EffectType type() const {
+    static constexpr EffectType type() {
         return CUSTOM;
     }
 
+    static constexpr const char* name() {
+        return "custom";
+    }
+
+    static constexpr const char* args() {
+        return "";
+    }
+
     template <typename Light>
     bool update(Light &light, uint32_t deltaTime) {
-        return true;
+        bool changed = dirty;
+        dirty = false;
+        return changed;
+    }
+
+    bool set(const char *param, const char *value) {
+        return false;
     }
 
     void writeToJSON(JsonDocument &json) const {
@@ -567,34 +940,384 @@ public:
     static CustomEffect readFromJSON(JsonDocument &json) {
         return CustomEffect();
     }
+
+    static CustomEffect fromArgs(int argc, const char *argv[]) {
+        return CustomEffect();
+    }
 };
 
-template <typename Light>
-Effect<Light> Effect<Light>::readFromJSON(JsonDocument &json) {
-    if (json.containsKey("mode")) {
-        EffectType mode = json["mode"].as<EffectType>();
-        switch (mode) {
-            case CONSTANT:
-                return ConstantEffect::readFromJSON(json);
-            case BLINK:
-                return BlinkEffect::readFromJSON(json);
-            case BREATH:
-                return BreathEffect::readFromJSON(json);
-            case CHASE:
-                return ChaseEffect::readFromJSON(json);
-            case RAINBOW:
-                return RainbowEffect::readFromJSON(json);
-            case STREAM:
-                return StreamEffect::readFromJSON(json);
-            case ANIMATION:
-                return AnimationEffect::readFromJSON(json);
-            case MUSIC:
-                return MusicEffect::readFromJSON(json);
-            case CUSTOM:
-                return CustomEffect::readFromJSON(json);
-        }
-    }
-    return ConstantEffect(DEFAULT_COLOR); // 默认为常亮
+// ==================== EffectRegistry ====================
+
+#define EFFECT_NAME_SIZE 12 // 灯效名称的最大长度, 含结尾的 '\0'
+#define EFFECT_ARGS_SIZE 32 // 灯效参数说明的最大长度, 含结尾的 '\0'
+#define EFFECT_HASH_SIZE 32 // 灯效名称散列表的大小
+
+template <size_t N>
+struct FixedString {
+    char str[N];
+};
+
+template <size_t N, size_t... I>
+constexpr FixedString<N> make_fixed_string(const char *str, index_seq<I...>) {
+    return FixedString<N>{{(I < str_length(str) ? str[I] : '\0')...}};
+}
+
+template <size_t N>
+constexpr FixedString<N> make_fixed_string(const char *str) {
+    return make_fixed_string<N>(str, typename make_index_seq<N>::type());
+}
+
+// 名称在给定种子下的 FNV-1a 散列值
+constexpr uint32_t name_hash(const char *str, uint32_t seed) {
+    return *str ? name_hash(str + 1, (seed ^ (uint8_t) *str) * 16777619u) : seed;
 }
 
+template <typename... Ts>
+struct EffectSlots {
+    static constexpr bool contains(uint32_t slot, uint32_t seed) { return false; }
+    static constexpr bool unique(uint32_t seed) { return true; }
+    static constexpr uint8_t indexOf(uint32_t slot, uint32_t seed, uint8_t index) { return 0xFF; }
+    static constexpr bool ordered(int index) { return true; }
+    static constexpr bool fits() { return true; }
+};
+
+template <typename T, typename... Rest>
+struct EffectSlots<T, Rest...> {
+    static constexpr uint32_t slot(uint32_t seed) {
+        return name_hash(T::name(), seed) % EFFECT_HASH_SIZE;
+    }
+    static constexpr bool contains(uint32_t slot, uint32_t seed) {
+        return EffectSlots<T, Rest...>::slot(seed) == slot || EffectSlots<Rest...>::contains(slot, seed);
+    }
+    static constexpr bool unique(uint32_t seed) {
+        return !EffectSlots<Rest...>::contains(slot(seed), seed) && EffectSlots<Rest...>::unique(seed);
+    }
+    static constexpr uint8_t indexOf(uint32_t slot, uint32_t seed, uint8_t index) {
+        return EffectSlots<T, Rest...>::slot(seed) == slot ? index : EffectSlots<Rest...>::indexOf(slot, seed, index + 1);
+    }
+    static constexpr bool ordered(int index) {
+        return T::type() == index && EffectSlots<Rest...>::ordered(index + 1);
+    }
+    static constexpr bool fits() {
+        return str_length(T::name()) < EFFECT_NAME_SIZE && str_length(T::args()) < EFFECT_ARGS_SIZE &&
+               EffectSlots<Rest...>::fits();
+    }
+};
+
+template <typename Registry, typename Seq>
+struct EffectHashTable;
+
+template <typename Registry, size_t... I>
+struct EffectHashTable<Registry, index_seq<I...>> {
+    static const uint8_t slots[sizeof...(I)];
+};
+
+template <typename Registry, size_t... I>
+const uint8_t EffectHashTable<Registry, index_seq<I...>>::slots[sizeof...(I)] PROGMEM = {
+    Registry::slotIndex(I)...
+};
+
+/**
+ * @brief Compile-time registry of all effect classes
+ *
+ * Each effect class declares its type(), name(), args(), fromArgs(), set()
+ * and JSON serializers once. The registry generates the name tables in PROGMEM and a
+ * perfect hash from name to type, whose seed is searched at compile time.
+ */
+template <typename... Ts>
+class EffectRegistry {
+private:
+    typedef EffectSlots<Ts...> Slots;
+    typedef EffectHashTable<EffectRegistry<Ts...>, typename make_index_seq<EFFECT_HASH_SIZE>::type> HashTable;
+
+    static constexpr uint32_t findSeed(uint32_t seed) {
+        return Slots::unique(seed) ? seed : findSeed(seed + 1);
+    }
+
+    static_assert(Slots::ordered(0), "Effects must be registered in EffectType order!");
+    static_assert(Slots::fits(), "Effect name or args too long!");
+
+public:
+    static constexpr uint32_t SEED = findSeed(0);
+
+    static const FixedString<EFFECT_NAME_SIZE> names[sizeof...(Ts)];
+    static const FixedString<EFFECT_ARGS_SIZE> args[sizeof...(Ts)];
+
+    static constexpr int count() {
+        return sizeof...(Ts);
+    }
+
+    static constexpr size_t storageSize() {
+        return max_of(sizeof(Ts)...);
+    }
+
+    static constexpr size_t storageAlign() {
+        return max_of(alignof(Ts)...);
+    }
+
+    static constexpr uint8_t slotIndex(uint32_t slot) {
+        return Slots::indexOf(slot, SEED, 0);
+    }
+
+    static EffectType find(const char *str) {
+        uint8_t index = pgm_read_byte(&HashTable::slots[name_hash(str, SEED) % EFFECT_HASH_SIZE]);
+        if (index < count() && strcmp_P(str, names[index].str) == 0) {
+            return (EffectType) index;
+        }
+        return EFFECT_TYPE_COUNT;
+    }
+};
+
+template <typename... Ts>
+const FixedString<EFFECT_NAME_SIZE> EffectRegistry<Ts...>::names[sizeof...(Ts)] PROGMEM = {
+    make_fixed_string<EFFECT_NAME_SIZE>(Ts::name())...
+};
+
+template <typename... Ts>
+const FixedString<EFFECT_ARGS_SIZE> EffectRegistry<Ts...>::args[sizeof...(Ts)] PROGMEM = {
+    make_fixed_string<EFFECT_ARGS_SIZE>(Ts::args())...
+};
+
+// 新增灯效时在 EffectType 中添加枚举值, 并按相同顺序在此注册
+typedef EffectRegistry<ConstantEffect, BlinkEffect, BreathEffect, ChaseEffect, RainbowEffect,
+                       StreamEffect, AnimationEffect, MusicEffect, CustomEffect> Effects;
+static_assert(Effects::count() == EFFECT_TYPE_COUNT, "Effects size mismatch!");
+
+template <typename Light>
+class Effect;
+
+// 由注册表生成的分发表
+template <typename Light, typename Registry>
+struct EffectTable;
+
+template <typename Light, typename... Ts>
+struct EffectTable<Light, EffectRegistry<Ts...>> {
+    template <typename T, typename Self, typename Visitor>
+    static typename Visitor::result_type invoke(Self &self, Visitor &visitor) {
+        return visitor(self.template as<T>());
+    }
+
+    template <typename Self, typename Visitor>
+    static typename Visitor::result_type visit(Self &self, Visitor &visitor) {
+        typedef typename Visitor::result_type (*Func)(Self &, Visitor &);
+        static const Func table[] PROGMEM = {&invoke<Ts, Self, Visitor>...};
+        if (self.empty()) {
+            return visitor();
+        }
+        Func func = (Func) pgm_read_ptr(&table[self.type()]);
+        return func(self, visitor);
+    }
+
+    template <typename T>
+    static Effect<Light> create(int argc, const char *argv[]) {
+        return T::fromArgs(argc, argv);
+    }
+
+    static Effect<Light> create(EffectType type, int argc, const char *argv[]) {
+        typedef Effect<Light> (*Func)(int, const char *[]);
+        static const Func table[] PROGMEM = {&create<Ts>...};
+        Func func = (Func) pgm_read_ptr(&table[type]);
+        return func(argc, argv);
+    }
+
+    template <typename T>
+    static Effect<Light> read(JsonDocument &json) {
+        return T::readFromJSON(json);
+    }
+
+    static Effect<Light> read(EffectType type, JsonDocument &json) {
+        typedef Effect<Light> (*Func)(JsonDocument &);
+        static const Func table[] PROGMEM = {&read<Ts>...};
+        Func func = (Func) pgm_read_ptr(&table[type]);
+        return func(json);
+    }
+};
+
+/**
+ * @brief Type-erased light effect stored in place
+ *
+ * The effect object lives in a fixed-size buffer sized at compile time to the
+ * largest registered effect class, and calls are dispatched through tables
+ * generated from the registry, so the Effect itself never touches the heap.
+ * AnimationEffect is the exception: opening an animation allocates its name,
+ * file handle and player (decoder state and prefetch ring).
+ */
+template <typename Light>
+class Effect {
+private:
+    typedef EffectTable<Light, Effects> Table;
+
+    static constexpr size_t STORAGE_SIZE = Effects::storageSize();
+    static constexpr size_t STORAGE_ALIGN = Effects::storageAlign();
+
+    EffectType _type;
+    typename std::aligned_storage<STORAGE_SIZE, STORAGE_ALIGN>::type _storage;
+
+    template <typename Self, typename Visitor>
+    static typename Visitor::result_type visit(Self &self, Visitor &&visitor) {
+        return Table::visit(self, visitor);
+    }
+
+    struct UpdateVisitor {
+        typedef bool result_type;
+        Light &light;
+        uint32_t deltaTime;
+        template <typename T>
+        bool operator()(T &impl) const { return impl.update(light, deltaTime); }
+        bool operator()() const { return false; }
+    };
+
+    struct WriteVisitor {
+        typedef void result_type;
+        JsonDocument &json;
+        template <typename T>
+        void operator()(const T &impl) const { impl.writeToJSON(json); }
+        void operator()() const {}
+    };
+
+    struct SetVisitor {
+        typedef bool result_type;
+        const char *param;
+        const char *value;
+        template <typename T>
+        bool operator()(T &impl) const { return impl.set(param, value); }
+        bool operator()() const { return false; }
+    };
+
+    struct MoveVisitor {
+        typedef void result_type;
+        void *storage;
+        template <typename T>
+        void operator()(T &impl) const {
+            ::new(storage) T(std::move(impl));
+            EffectCounters::created++;
+        }
+        void operator()() const {}
+    };
+
+    struct DestroyVisitor {
+        typedef void result_type;
+        template <typename T>
+        void operator()(T &impl) const {
+            impl.~T();
+            EffectCounters::destroyed++;
+        }
+        void operator()() const {}
+    };
+
+    void destroy() {
+        visit(*this, DestroyVisitor());
+        _type = EFFECT_TYPE_COUNT;
+    }
+
+public:
+    Effect() noexcept : _type(EFFECT_TYPE_COUNT) {}
+
+    template <typename T, typename Impl = typename std::decay<T>::type,
+              typename = typename std::enable_if<!std::is_same<Impl, Effect<Light>>::value>::type>
+    Effect(T &&impl) : _type(impl.type()) {
+        static_assert(sizeof(Impl) <= STORAGE_SIZE, "Effect storage too small!");
+        ::new(&_storage) Impl(std::forward<T>(impl));
+        EffectCounters::created++;
+    }
+
+    Effect(const Effect<Light> &) = delete;
+    Effect<Light>& operator=(const Effect<Light> &) = delete;
+
+    Effect(Effect<Light> &&other) : _type(other._type) {
+        visit(other, MoveVisitor{&_storage});
+    }
+
+    ~Effect() {
+        destroy();
+    }
+
+    Effect<Light>& operator=(Effect<Light> &&other) {
+        if (this != &other) {
+            destroy();
+            visit(other, MoveVisitor{&_storage});
+            _type = other._type;
+        }
+        return *this;
+    }
+
+    template <typename T, typename Impl = typename std::decay<T>::type,
+              typename = typename std::enable_if<!std::is_same<Impl, Effect<Light>>::value>::type>
+    Effect<Light>& operator=(T &&impl) {
+        static_assert(sizeof(Impl) <= STORAGE_SIZE, "Effect storage too small!");
+        EffectType type = impl.type();
+        destroy();
+        ::new(&_storage) Impl(std::forward<T>(impl));
+        EffectCounters::created++;
+        _type = type;
+        return *this;
+    }
+
+    template <typename T>
+    T& as() {
+        return *reinterpret_cast<T *>(&_storage);
+    }
+
+    template <typename T>
+    const T& as() const {
+        return *reinterpret_cast<const T *>(&_storage);
+    }
+
+    bool empty() const {
+        return _type == EFFECT_TYPE_COUNT;
+    }
+
+    EffectType type() const {
+        return _type;
+    }
+
+    bool update(Light &light, uint32_t deltaTime) {
+        if (empty()) { // 空灯效不计入性能统计, 也没有对应的阶段名
+            return false;
+        }
+        PERF_SCOPE(PERF_EFFECT + _type);
+        return visit(*this, UpdateVisitor{light, deltaTime});
+    }
+
+    /**
+     * @brief Update a parameter of the running effect in place
+     *
+     * The effect keeps its clock, so changing a parameter does not restart it.
+     *
+     * @param param parameter name, see args() of each effect class
+     * @param value parameter value
+     * @return bool whether the parameter exists and the value is valid
+     */
+    bool set(const char *param, const char *value) {
+        return visit(*this, SetVisitor{param, value});
+    }
+
+    void writeToJSON(JsonDocument &json) const {
+        json["mode"] = type();
+        visit(*this, WriteVisitor{json});
+    }
+
+    /**
+     * @brief Create an effect from command arguments
+     *
+     * @param type effect type, must be valid
+     * @param argc argument count
+     * @param argv arguments, see args() of each effect class
+     * @return Effect<Light> created effect
+     */
+    static Effect<Light> create(EffectType type, int argc, const char *argv[]) {
+        return Table::create(type, argc, argv);
+    }
+
+    static Effect<Light> readFromJSON(JsonDocument &json) {
+        if (json.containsKey("mode")) {
+            EffectType mode = json["mode"].as<EffectType>();
+            if (mode >= CONSTANT && mode < EFFECT_TYPE_COUNT) {
+                return Table::read(mode, json);
+            }
+        }
+        return ConstantEffect(DEFAULT_COLOR); // 默认为常亮
+    }
+};
+
 #endif // __LIGHTEFFECT_HPP__
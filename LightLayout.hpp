@@ -0,0 +1,436 @@
+#ifndef __LIGHTLAYOUT_HPP__
+#define __LIGHTLAYOUT_HPP__
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include <ArduinoJson.h>
+#include <LittleFS.h>
+
+#include "config.h"
+#include "Light.hpp"
+
+enum LayoutType {
+    LAYOUT_STRIP, // 灯带, 参数同 LightStrip
+    LAYOUT_PANEL, // 灯板, 参数同 LightPanel
+    LAYOUT_DISC,  // 灯盘, 参数同 LightDisc
+    LAYOUT_TYPE_COUNT
+};
+
+/**
+ * @brief Get layout type enum from name
+ *
+ * @param str layout type name
+ * @return LayoutType layout type enum
+ */
+LayoutType str2layout(const char *str);
+
+/**
+ * @brief Get name from layout type enum
+ *
+ * @param type layout type enum
+ * @return const char* layout type name
+ */
+const char* layout2str(LayoutType type);
+
+/**
+ * @brief Light whose topology is read from a file at boot
+ *
+ * The topology is flattened into a table from logical position to LED index,
+ * grouped by slice (a pixel of a strip, a row of a panel, a ring of a disc),
+ * so effects walk the table instead of decoding the arrangement per pixel.
+ * The table is shared by every frame of the same capacity, each frame only
+ * holds its LEDs.
+ *
+ * @tparam CAPACITY maximum number of LEDs
+ */
+template <int CAPACITY>
+class LightLayout {
+    static_assert(CAPACITY > 0 && CAPACITY <= UINT16_MAX, "LightLayout capacity out of range!");
+
+private:
+    struct Topology {
+        LayoutType type;
+        uint8_t arrangement;          // 灯板和灯盘的排列方式, 灯带为是否反向
+        uint16_t width;               // 灯板宽度
+        uint16_t count;               // 灯珠数
+        uint16_t sliceCount;          // 切片数
+        bool contiguous;              // 每个切片的灯珠序号都是连续的一段
+        uint16_t order[CAPACITY];     // 逻辑位置对应的灯珠序号, 按切片分组
+        uint16_t starts[CAPACITY + 1]; // 每个切片在 order 中的起点
+
+        Topology() {
+            strip(CAPACITY, false);
+        }
+
+        void strip(int n, bool reverse) {
+            type = LAYOUT_STRIP;
+            arrangement = reverse;
+            width = n;
+            count = sliceCount = n;
+            for (int i = 0; i < n; i++) {
+                order[i] = reverse ? n - i - 1 : i;
+                starts[i] = i;
+            }
+            starts[n] = n;
+            findRuns();
+        }
+
+        void panel(int w, int h, int arr) {
+            type = LAYOUT_PANEL;
+            arrangement = arr;
+            width = w;
+            count = w * h;
+            sliceCount = h;
+            for (int y = 0; y < h; y++) {
+                starts[y] = y * w;
+                for (int x = 0; x < w; x++) {
+                    order[y * w + x] = panel_index(w, h, arr, x, y);
+                }
+            }
+            starts[h] = count;
+            findRuns();
+        }
+
+        // rings 为各环灯珠数, 可为 JsonArray 或数组
+        template <typename Rings>
+        void disc(int arr, const Rings &rings, int ringCount) {
+            type = LAYOUT_DISC;
+            arrangement = arr;
+            width = 0;
+            count = 0;
+            sliceCount = ringCount;
+            int total = 0;
+            for (int ring = 0; ring < ringCount; ring++) {
+                total += (int) rings[ring];
+            }
+            for (int ring = 0; ring < sliceCount; ring++) {
+                int n = rings[ring];
+                // 与 LightDisc 的 OffsetGenerator 相同, 从内到外时内环在前
+                int offset = arr & INSIDE_OUT ? total - count - n : count;
+                starts[ring] = count;
+                for (int i = 0; i < n; i++) {
+                    order[count + i] = offset + (arr & ANTICLOCKWISE ? n - i - 1 : i);
+                }
+                count += n;
+            }
+            starts[sliceCount] = count;
+            findRuns();
+        }
+
+        // order 是灯珠序号的一个排列, 切片内最大与最小序号之差为灯珠数减一时即为连续的一段
+        void findRuns() {
+            contiguous = true;
+            for (int slice = 0; slice < sliceCount && contiguous; slice++) {
+                if (starts[slice] == starts[slice + 1]) {
+                    continue;
+                }
+                const uint16_t *begin = order + starts[slice], *end = order + starts[slice + 1];
+                contiguous = *std::max_element(begin, end) - *std::min_element(begin, end) == end - begin - 1;
+            }
+        }
+    };
+
+    static Topology topology;
+
+    alignas(4) CRGB leds[CAPACITY]; // 4 字节对齐以便按字处理
+
+    // 填充 order 中 [index, end) 的灯珠, 序号连续时整段填充, 不必逐个查表
+    void fillSlice(const uint16_t *index, const uint16_t *end, bool contiguous, CRGB color) {
+        if (end - index == 1) { // 灯带的切片只有一个灯珠
+            this->leds[*index] = color;
+        } else if (contiguous) {
+            if (index != end) {
+                fill_solid(this->leds + std::min(*index, *(end - 1)), end - index, color);
+            }
+        } else {
+            while (index != end) {
+                this->leds[*index++] = color;
+            }
+        }
+    }
+
+public:
+    CRGB* data() {
+        return this->leds;
+    }
+
+    static int count() {
+        return topology.count;
+    }
+
+    static LayoutType type() {
+        return topology.type;
+    }
+
+    // 逻辑位置 pos 的灯珠, 灯板为 y * w + x, 灯盘为各环依次排列
+    CRGB& at(int pos) {
+        return this->leds[topology.order[pos]];
+    }
+
+    static int slices() {
+        return topology.sliceCount;
+    }
+
+    void fillSlice(int slice, CRGB color) {
+        fillSlice(topology.order + topology.starts[slice], topology.order + topology.starts[slice + 1],
+                  topology.contiguous, color);
+    }
+
+    /**
+     * @brief Fill every slice with a color computed from its index, see shade()
+     *
+     * The topology is read into locals once, since writes to the LEDs may
+     * alias it and calling fillSlice(slice, color) would reload it per slice.
+     *
+     * @param shader function from slice index to color
+     */
+    template <typename Shader>
+    void shadeSlices(Shader shader) {
+        const uint16_t *order = topology.order;
+        const uint16_t *starts = topology.starts;
+        bool contiguous = topology.contiguous;
+        int n = topology.sliceCount;
+        if (topology.type == LAYOUT_STRIP) { // 灯带每个切片一个灯珠, 不必查切片起点
+            for (int i = 0; i < n; i++) {
+                this->leds[order[i]] = shader(i);
+            }
+            return;
+        }
+        const uint16_t *begin = order;
+        for (int i = 0; i < n; i++) {
+            const uint16_t *end = order + starts[i + 1];
+            fillSlice(begin, end, contiguous, shader(i));
+            begin = end;
+        }
+    }
+
+    /**
+     * @brief Compute every LED from its coordinate, same as the fixed lights
+     *
+     * @param f function from LightPoint to color
+     */
+    template <typename F>
+    void shadePixels(F f) {
+        // 拓扑先读入局部变量, 写灯珠可能与其别名, 否则每个灯珠都要重新读取
+        const uint16_t *index = topology.order;
+        const uint16_t *starts = topology.starts;
+        int count = topology.count;
+        int slices = topology.sliceCount;
+        int width = topology.width;
+        switch (topology.type) {
+            case LAYOUT_STRIP: {
+                AxisWalker x(255, count - 1);
+                for (int i = 0; i < count; i++) {
+                    this->leds[*index++] = f(LightPoint{x.next(), 0, 0});
+                }
+                break;
+            }
+            case LAYOUT_PANEL: {
+                AxisWalker y(255, slices - 1);
+                for (int row = 0; row < slices; row++) {
+                    uint8_t py = y.next();
+                    AxisWalker x(255, width - 1);
+                    for (int i = 0; i < width; i++) {
+                        this->leds[*index++] = f(LightPoint{x.next(), py, 0});
+                    }
+                }
+                break;
+            }
+            default: {
+                int largest = 0;
+                for (int ring = 0; ring < slices; ring++) {
+                    largest = std::max(largest, starts[ring + 1] - starts[ring]);
+                }
+                // 与 LightDisc 相同, 半径与该环灯珠数成正比, 角度按顺时针增大
+                for (int ring = 0; ring < slices; ring++) {
+                    int n = starts[ring + 1] - starts[ring];
+                    uint8_t radius = n * 255 / largest;
+                    AxisWalker angle(256, n);
+                    for (int i = 0; i < n; i++) {
+                        this->leds[*index++] = f(LightPoint{angle.next(), radius, 0});
+                    }
+                }
+                break;
+            }
+        }
+    }
+
+    /**
+     * @brief Count the LEDs of a topology without applying it
+     *
+     * @param json topology, e.g. {"type":"panel","width":16,"height":16,"arrangement":1}
+     * @return int number of LEDs, 0 if the topology is invalid or exceeds the capacity
+     */
+    static int countOf(JsonDocument &json) {
+        int n = 0;
+        switch (str2layout(json["type"] | "")) {
+            case LAYOUT_STRIP:
+                n = json["count"] | 0;
+                break;
+            case LAYOUT_PANEL:
+                n = (json["width"] | 0) * (json["height"] | 0);
+                if ((json["width"] | 0) <= 0 || (json["height"] | 0) <= 0) {
+                    return 0;
+                }
+                break;
+            case LAYOUT_DISC: {
+                JsonArray rings = json["rings"];
+                if (rings.size() == 0) {
+                    return 0;
+                }
+                for (JsonVariant ring : rings) {
+                    if (ring.as<int>() <= 0) {
+                        return 0;
+                    }
+                    n += ring.as<int>();
+                }
+                break;
+            }
+            default:
+                return 0;
+        }
+        return n > 0 && n <= CAPACITY ? n : 0;
+    }
+
+    /**
+     * @brief Apply a topology, only safe before effects start
+     *
+     * @param json topology, see countOf
+     * @return true if the topology is valid
+     */
+    static bool readFromJSON(JsonDocument &json) {
+        if (countOf(json) == 0) {
+            return false;
+        }
+        switch (str2layout(json["type"] | "")) {
+            case LAYOUT_STRIP:
+                topology.strip(json["count"], json["reverse"] | false);
+                break;
+            case LAYOUT_PANEL:
+                topology.panel(json["width"], json["height"], json["arrangement"] | 0);
+                break;
+            default: {
+                JsonArray rings = json["rings"];
+                topology.disc(json["arrangement"] | 0, rings, rings.size());
+                break;
+            }
+        }
+        return true;
+    }
+
+    static void writeToJSON(JsonDocument &json) {
+        json["type"] = layout2str(topology.type);
+        switch (topology.type) {
+            case LAYOUT_STRIP:
+                json["count"] = topology.count;
+                json["reverse"] = (bool) topology.arrangement;
+                break;
+            case LAYOUT_PANEL:
+                json["width"] = topology.width;
+                json["height"] = topology.sliceCount;
+                json["arrangement"] = topology.arrangement;
+                break;
+            default: {
+                json["arrangement"] = topology.arrangement;
+                JsonArray rings = json.createNestedArray("rings");
+                for (int i = 0; i < topology.sliceCount; i++) {
+                    rings.add(topology.starts[i + 1] - topology.starts[i]);
+                }
+                break;
+            }
+        }
+        json["capacity"] = CAPACITY;
+    }
+
+    /**
+     * @brief Load the topology from a file, or use a strip of full capacity
+     *
+     * @param path path of the JSON file
+     * @return true if the file is loaded
+     */
+    static bool load(const char *path) {
+        if (LittleFS.exists(path)) {
+            StaticJsonDocument<512> doc;
+            File file = LittleFS.open(path, "r");
+            DeserializationError error = deserializeJson(doc, file);
+            file.close();
+            if (!error && readFromJSON(doc)) {
+                return true;
+            }
+        }
+        topology.strip(CAPACITY, false);
+        return false;
+    }
+};
+
+template <int CAPACITY>
+typename LightLayout<CAPACITY>::Topology LightLayout<CAPACITY>::topology;
+
+template <int CAPACITY>
+struct LightCapacity<LightLayout<CAPACITY>> {
+    static constexpr int value = CAPACITY;
+};
+
+/**
+ * @brief Load the topology of a light configurable at runtime
+ *
+ * Lights with a compile-time topology ignore the file.
+ *
+ * @param light light to load
+ * @param path path of the JSON file
+ * @return true if the file is loaded
+ */
+template <typename Light>
+bool load_layout(Light &light, const char *path) {
+    return false;
+}
+
+template <int CAPACITY>
+bool load_layout(LightLayout<CAPACITY> &light, const char *path) {
+    return LightLayout<CAPACITY>::load(path);
+}
+
+/**
+ * @brief Describe the topology of a light
+ *
+ * @param light light to describe
+ * @param json JSON document to write to
+ * @return true if the topology can be changed at runtime
+ */
+template <typename Light>
+bool layout_to_json(const Light &light, JsonDocument &json) {
+    json["count"] = light.count();
+    json["slices"] = light.slices();
+    return false;
+}
+
+template <int CAPACITY>
+bool layout_to_json(const LightLayout<CAPACITY> &light, JsonDocument &json) {
+    LightLayout<CAPACITY>::writeToJSON(json);
+    return true;
+}
+
+/**
+ * @brief Check a topology against the capacity of a light
+ *
+ * @param light light to check against
+ * @param json topology
+ * @return int number of LEDs, 0 if invalid or the topology is fixed
+ */
+template <typename Light>
+int layout_count(const Light &light, JsonDocument &json) {
+    return 0;
+}
+
+template <int CAPACITY>
+int layout_count(const LightLayout<CAPACITY> &light, JsonDocument &json) {
+    return LightLayout<CAPACITY>::countOf(json);
+}
+
+// 运行时形态一次读入拓扑再逐个切片填充
+template <int CAPACITY, typename Shader>
+void shade(LightLayout<CAPACITY> &light, Shader shader) {
+    light.shadeSlices(shader);
+}
+
+#endif // __LIGHTLAYOUT_HPP__
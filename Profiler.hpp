@@ -0,0 +1,158 @@
+#ifndef __PROFILER_HPP__
+#define __PROFILER_HPP__
+
+#include "config.h"
+
+enum PerfStage {
+    PERF_COMPOSE,     // 图层合成与过渡混合
+    PERF_SHOW,        // 输出一帧, 亮度和色温缩放由 FastLED 在输出时完成
+    PERF_WEBSOCKET,   // 处理 WebSocket 消息
+    PERF_CONFIG_SAVE, // 保存配置
+    PERF_EFFECT,      // 灯效更新, 按 EffectType 顺序每种灯效各占一个阶段
+    PERF_STAGE_COUNT = PERF_EFFECT + 16
+};
+
+#ifdef ENABLE_PROFILER
+
+#include <algorithm>
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#ifndef ARDUINO
+#include <chrono>
+#endif
+
+#define PERF_BUCKETS 33 // 按耗时的二进制位数分桶, 耗时为 0 时单独一桶
+
+/**
+ * @brief Per-stage timing statistics with a log2 histogram
+ *
+ * Durations are measured in CPU cycles on the device and in nanoseconds on a
+ * host build. Every sample since the last reset is counted in the bucket of
+ * its bit length, and percentiles are read from the cumulative counts, so
+ * they are upper bounds within a factor of 2, capped at the maximum.
+ */
+class Profiler {
+private:
+    struct Stage {
+        uint32_t count;
+        uint32_t min;
+        uint32_t max;
+        uint64_t sum;
+        uint32_t buckets[PERF_BUCKETS]; // 第 b 桶为 [2^(b-1), 2^b - 1]
+    };
+
+    Stage stages[PERF_STAGE_COUNT];
+
+    static int bucket(uint32_t duration) {
+        return duration ? 32 - __builtin_clz(duration) : 0;
+    }
+
+public:
+    /**
+     * @brief Upper bound of a percentile of a stage
+     *
+     * @param stage stage with samples
+     * @param percent percentile (1-100)
+     * @return uint32_t upper bound of the bucket holding the nearest-rank sample, at most max
+     */
+    uint32_t percentile(int stage, int percent) const {
+        const Stage &s = stages[stage];
+        uint64_t rank = std::max<uint64_t>(((uint64_t) s.count * percent + 99) / 100, 1);
+        uint64_t seen = 0;
+        for (int b = 0; b < PERF_BUCKETS; b++) {
+            seen += s.buckets[b];
+            if (seen >= rank) {
+                return std::min<uint32_t>((1ull << b) - 1, s.max);
+            }
+        }
+        return s.max;
+    }
+
+    Profiler() {
+        reset();
+    }
+
+    static uint32_t now() {
+#ifdef ARDUINO
+        return ESP.getCycleCount();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    void record(int stage, uint32_t duration) {
+        Stage &s = stages[stage];
+        s.buckets[bucket(duration)]++;
+        s.count++;
+        s.min = std::min(s.min, duration);
+        s.max = std::max(s.max, duration);
+        s.sum += duration;
+    }
+
+    void reset() {
+        for (Stage &s : stages) {
+            s.count = 0;
+            s.min = UINT32_MAX;
+            s.max = 0;
+            s.sum = 0;
+            memset(s.buckets, 0, sizeof(s.buckets));
+        }
+    }
+
+    /**
+     * @brief Dump statistics of all stages that have samples
+     *
+     * @param json JSON document to write to
+     * @param stageName function to get the name of a stage
+     */
+    void writeToJSON(JsonDocument &json, const __FlashStringHelper *(*stageName)(int stage)) const {
+#ifdef ARDUINO
+        json["unit"] = "cycles";
+#else
+        json["unit"] = "ns";
+#endif
+        JsonObject obj = json.createNestedObject("stages");
+        for (int i = 0; i < PERF_STAGE_COUNT; i++) {
+            const Stage &s = stages[i];
+            if (s.count == 0) {
+                continue;
+            }
+            JsonObject stage = obj.createNestedObject(stageName(i));
+            stage["count"] = s.count;
+            stage["min"] = s.min;
+            stage["avg"] = (uint32_t) (s.sum / s.count);
+            stage["p50"] = percentile(i, 50);
+            stage["p99"] = percentile(i, 99);
+            stage["max"] = s.max;
+        }
+    }
+};
+
+extern Profiler profiler;
+
+class PerfScope {
+private:
+    int stage;
+    uint32_t start;
+
+public:
+    PerfScope(int stage) : stage(stage), start(Profiler::now()) {}
+
+    ~PerfScope() {
+        profiler.record(stage, Profiler::now() - start);
+    }
+};
+
+#define PERF_CONCAT_(a, b) a##b
+#define PERF_CONCAT(a, b) PERF_CONCAT_(a, b)
+// 统计当前作用域的耗时
+#define PERF_SCOPE(stage) PerfScope PERF_CONCAT(perfScope, __LINE__)(stage)
+
+#else
+
+#define PERF_SCOPE(stage)
+
+#endif // ENABLE_PROFILER
+
+#endif // __PROFILER_HPP__
@@ -16,7 +16,6 @@
 #include <ESP8266WiFi.h>
 #include <ESP8266mDNS.h>
 #include <LittleFS.h>
-#include <Ticker.h>
 #include <Updater.h>
 #include <WebSocketsServer.h>
 #include <WiFiUdp.h>
@@ -28,8 +27,13 @@
 #endif
 
 #include "CommandHandler.hpp"
+#include "CubeRenderer.hpp"
+#include "FrameScheduler.hpp"
 #include "Light.hpp"
+#include "LightCompositor.hpp"
 #include "LightEffect.hpp"
+#include "LightLayout.hpp"
+#include "Profiler.hpp"
 #include "utils.h"
 
 #define MIME_TYPE(t) (mime::mimeTable[mime::type::t].mimeType)
@@ -38,12 +42,14 @@ const char *product_name = "rgblight";
 const char *model_name = MODEL;
 const char *version = VERSION;
 const uint32_t version_code = VERSION_CODE;
-typedef std::function<Effect<LIGHT_TYPE>(int argc, const char *argv[])> CreateEffectFunc;
 
-CreateEffectFunc effectFactories[EFFECT_TYPE_COUNT];
-Ticker timer;
-LIGHT_TYPE light;
+FrameScheduler scheduler;
+FrameTrace<16> frameTrace;
+DoubleBuffer<LIGHT_TYPE> light;
 Effect<LIGHT_TYPE> lightEffect;
+Compositor<LIGHT_TYPE, MAX_LAYER_COUNT> compositor;
+Segments<LIGHT_TYPE, MAX_SEGMENT_COUNT> segments;
+Transition<LIGHT_TYPE> transition;
 DNSServer dnsServer;
 ESP8266WebServer webServer(80);
 WebSocketsServer wsServer(81);
@@ -59,10 +65,10 @@ struct Config {
     uint16_t refreshRate; // 刷新率, 默认 60Hz
     uint8_t brightness;   // 亮度, 默认 63
     uint32_t temperature; // 色温, 默认 6600K
+    uint16_t transition;  // 灯效切换过渡时长, 默认 0ms
 } config;
 
-// For LightEffect
-const uint16_t &fps = config.refreshRate;
+FrameStats frameStats;
 
 void markDirty() {
     config.lastModifyTime = millis();
@@ -77,10 +83,12 @@ void serializeSettings(JsonDocument &doc) {
     doc["refreshRate"] = config.refreshRate;
     doc["brightness"] = config.brightness;
     doc["temperature"] = config.temperature;
+    doc["transition"] = config.transition;
     lightEffect.writeToJSON(doc);
 }
 
 void saveSettings() {
+    PERF_SCOPE(PERF_CONFIG_SAVE);
     Serial.println(F("Save settings"));
     StaticJsonDocument<1024> doc;
     doc["version"] = version_code;
@@ -122,11 +130,12 @@ void readSettings() {
     config.refreshRate = doc["refreshRate"] | 60;
     config.brightness = doc["brightness"] | 63;
     config.temperature = doc["temperature"] | 6600;
+    config.transition = doc["transition"] | 0;
     lightEffect = Effect<LIGHT_TYPE>::readFromJSON(doc);
 
     FastLED.setBrightness(config.brightness);
     FastLED.setTemperature(CRGB(kelvin2rgb(config.temperature)));
-    timer.attach_ms(1000 / config.refreshRate, updateLight);
+    scheduler.setRate(config.refreshRate);
 
     if (shouldSave) {
         saveSettings();
@@ -190,11 +199,45 @@ bool startHotspot() {
     return result;
 }
 
-void updateLight() {
-    if (lightEffect.update(light, 0)) {
+// 在空闲时间提前渲染下一帧到后台缓冲
+void renderFrame() {
+    uint32_t renderStart = micros();
+    static uint32_t lastTime = scheduler.nextDeadline();
+    uint32_t now = scheduler.nextDeadline(); // 灯效时间以该帧的输出时刻为准
+    uint32_t deltaTime = now - lastTime;     // 无符号相减, micros() 回绕时仍然正确
+    if ((int32_t) deltaTime < 0) {           // 截止时间提前时灯效时间停住, 不回绕成极大值
+        deltaTime = 0;
+    } else {
+        lastTime = now;
+    }
+    bool changed;
+    {
+        PERF_SCOPE(PERF_COMPOSE);
+        changed = transition.update(lightEffect, compositor.target(light), deltaTime);
+        changed = compositor.compose(light, changed, deltaTime);
+        if (segments.update(deltaTime)) { // 分段在输出时叠加, 不计入底层画面的哈希
+            frameStats.ready = true;
+        }
+    }
+    if (changed) {
+        frameStats.render(hash_frame(light.data(), light.count()));
+    }
+    frameTrace.render(renderStart, micros());
+}
+
+// 在帧边界输出已渲染好的帧
+void presentFrame(uint32_t deadline) {
+    if (!frameStats.push()) {
+        return;
+    }
+    uint32_t showStart = micros();
+    {
+        PERF_SCOPE(PERF_SHOW);
+        light.swap();
+        segments.overlay(light, light.front());
         FastLED.show();
-        // delayMicroseconds(100);
     }
+    frameTrace.show(deadline, showStart, micros());
 }
 
 void handleCommand(SenderFunc sender, char *line) {
@@ -207,61 +250,30 @@ void handleCommand(SenderFunc sender, char *line) {
     } else if (lightEffect.type() == CUSTOM) {
         if (!isalpha(line[0])) {
             uint32_t color = str2hex(line);
-            int &index = lightEffect.as<CustomEffect>().getIndex();
-            light.data()[index++] = CRGB(color);
-            if (index >= light.count()) {
-                index = 0;
-            }
+            lightEffect.as<CustomEffect>().push(
+                transition.target(compositor.target(light)), CRGB(color));
             return;
         }
     }
     cmdHandler.parseCommand(sender, line);
 }
 
-void initEffects() {
-    effectFactories[CONSTANT] = [](int argc, const char *argv[]) {
-        uint32_t color = argc > 0 ? str2hex(argv[0]) : DEFAULT_COLOR;
-        return ConstantEffect(color);
-    };
-    effectFactories[BLINK] = [](int argc, const char *argv[]) {
-        uint32_t color = argc > 0 ? str2hex(argv[0]) : DEFAULT_COLOR;
-        float lastTime = argc > 1 ? atof(argv[1]) : 1.0;
-        float interval = argc > 2 ? atof(argv[2]) : 1.0;
-        return BlinkEffect(color, lastTime, interval);
-    };
-    effectFactories[BREATH] = [](int argc, const char *argv[]) {
-        uint32_t color = argc > 0 ? str2hex(argv[0]) : DEFAULT_COLOR;
-        float lastTime = argc > 1 ? atof(argv[1]) : 1.0;
-        float interval = argc > 2 ? atof(argv[2]) : 0.5;
-        return BreathEffect(color, lastTime, interval);
-    };
-    effectFactories[CHASE] = [](int argc, const char *argv[]) {
-        uint32_t color = argc > 0 ? str2hex(argv[0]) : DEFAULT_COLOR;
-        uint8_t direction = argc > 1 ? atoi(argv[1]) : 0;
-        float lastTime = argc > 2 ? atof(argv[2]) : 0.2;
-        return ChaseEffect(color, direction, lastTime);
-    };
-    effectFactories[RAINBOW] = [](int argc, const char *argv[]) {
-        int8_t delta = argc > 0 ? atoi(argv[0]) : 1;
-        return RainbowEffect(delta);
-    };
-    effectFactories[STREAM] = [](int argc, const char *argv[]) {
-        uint8_t direction = argc > 0 ? atoi(argv[0]) : 0;
-        int8_t delta = argc > 1 ? atoi(argv[1]) : 1;
-        return StreamEffect(direction, delta);
-    };
-    effectFactories[ANIMATION] = [](int argc, const char *argv[]) {
-        const char *name = argc > 0 ? argv[0] : "";
-        return AnimationEffect(name);
-    };
-    effectFactories[MUSIC] = [](int argc, const char *argv[]) {
-        uint8_t mode = argc > 0 ? atoi(argv[0]) : 1;
-        return MusicEffect(mode);
-    };
-    effectFactories[CUSTOM] = [](int argc, const char *argv[]) {
-        return CustomEffect();
-    };
+#ifdef ENABLE_PROFILER
+const __FlashStringHelper* perfStageName(int stage) {
+    switch (stage) {
+    case PERF_COMPOSE:
+        return F("compose");
+    case PERF_SHOW:
+        return F("show");
+    case PERF_WEBSOCKET:
+        return F("websocket");
+    case PERF_CONFIG_SAVE:
+        return F("configSave");
+    default:
+        return effect2str((EffectType)(stage - PERF_EFFECT));
+    }
 }
+#endif
 
 void registerCommands() {
     cmdHandler.setDefaultHandler([](SenderFunc sender, int argc, char *argv[]) {
@@ -277,6 +289,21 @@ void registerCommands() {
                                    printSystemInfo();
                                    printWifiInfo();
                                });
+#endif
+#ifdef ENABLE_PROFILER
+    cmdHandler.registerCommand("perf", "Show/reset performance stats",
+                               [](SenderFunc sender, int argc, char *argv[]) {
+                                   if (argc > 1 && strcmp(argv[1], "reset") == 0) {
+                                       profiler.reset();
+                                       sender("OK");
+                                       return;
+                                   }
+                                   DynamicJsonDocument doc(2048);
+                                   profiler.writeToJSON(doc, perfStageName);
+                                   String str;
+                                   serializeJson(doc, str);
+                                   sender(str.c_str());
+                               });
 #endif
     cmdHandler.registerCommand("version", "Show version",
                                [](SenderFunc sender, int argc, char *argv[]) {
@@ -293,12 +320,21 @@ void registerCommands() {
                                });
     cmdHandler.registerCommand(
         "status", "Show status", [](SenderFunc sender, int argc, char *argv[]) {
-            StaticJsonDocument<256> doc;
+            StaticJsonDocument<512> doc;
             doc["vcc"] = ESP.getVcc() / 1000.0;
             doc["resetReason"] = ESP.getResetReason();
             doc["freeHeap"] = ESP.getFreeHeap();
             doc["heapFragment"] = ESP.getHeapFragmentation();
             doc["maxFreeBlock"] = ESP.getMaxFreeBlockSize();
+            doc["liveEffects"] = EffectCounters::alive();
+            doc["openAnimFiles"] = EffectCounters::openFiles;
+            uint32_t prefetched, prefetchCapacity;
+            AnimPlayer::stats(prefetched, prefetchCapacity);
+            doc["animPrefetched"] = prefetched;
+            doc["animPrefetchCapacity"] = prefetchCapacity;
+            doc["animUnderruns"] = AnimPlayer::underruns;
+            doc["framesRendered"] = frameStats.rendered;
+            doc["framesPushed"] = frameStats.pushed;
             doc["RSSI"] = WiFi.RSSI();
             FSInfo fs_info;
             LittleFS.info(fs_info);
@@ -393,14 +429,206 @@ void registerCommands() {
             }
             EffectType type = str2effect(argv[1]);
             if (type >= CONSTANT && type < EFFECT_TYPE_COUNT) {
-                lightEffect =
-                    effectFactories[type](argc - 2, (const char **)argv + 2);
+                transition.start(lightEffect,
+                                 Effect<LIGHT_TYPE>::create(type, argc - 2, (const char **)argv + 2),
+                                 compositor.target(light), config.transition);
                 markDirty();
                 sender("OK");
             } else {
                 sender("INVAILD");
             }
         });
+    cmdHandler.registerCommand("set", "Set a parameter of current light mode",
+                               [](SenderFunc sender, int argc, char *argv[]) {
+                                   if (argc > 2 && lightEffect.set(argv[1], argv[2])) {
+                                       markDirty();
+                                       sender("OK");
+                                   } else {
+                                       sender("INVAILD");
+                                   }
+                               });
+    cmdHandler.registerCommand("effects", "List light modes and their arguments",
+                               [](SenderFunc sender, int argc, char *argv[]) {
+                                   StaticJsonDocument<768> doc;
+                                   JsonArray array = doc.to<JsonArray>();
+                                   for (int i = 0; i < EFFECT_TYPE_COUNT; i++) {
+                                       JsonObject obj = array.createNestedObject();
+                                       obj["name"] = effect2str((EffectType)i);
+                                       obj["args"] = effect2args((EffectType)i);
+                                   }
+                                   String str;
+                                   serializeJson(doc, str);
+                                   sender(str.c_str());
+                               });
+    cmdHandler.registerCommand("timing", "Show/reset frame timing",
+                               [](SenderFunc sender, int argc, char *argv[]) {
+                                   if (argc > 1 && strcmp(argv[1], "reset") == 0) {
+                                       scheduler.reset();
+                                       sender("OK");
+                                       return;
+                                   }
+                                   StaticJsonDocument<256> doc;
+                                   scheduler.writeToJSON(doc);
+                                   String str;
+                                   serializeJson(doc, str);
+                                   sender(str.c_str());
+                               });
+    cmdHandler.registerCommand("trace", "Show recent frame timings",
+                               [](SenderFunc sender, int argc, char *argv[]) {
+                                   DynamicJsonDocument doc(2048);
+                                   JsonArray array = doc.to<JsonArray>();
+                                   frameTrace.writeToJSON(array);
+                                   String str;
+                                   serializeJson(doc, str);
+                                   sender(str.c_str());
+                               });
+    cmdHandler.registerCommand("transition", "Get/set transition time",
+                               [](SenderFunc sender, int argc, char *argv[]) {
+                                   if (argc <= 1) {
+                                       String str = String(config.transition) + String("ms");
+                                       sender(str.c_str());
+                                       return;
+                                   }
+                                   int ms = atoi(argv[1]);
+                                   if (ms >= 0 && ms <= 60000) {
+                                       if (config.transition != ms) {
+                                           config.transition = (uint16_t)ms;
+                                           markDirty();
+                                       }
+                                       sender("OK");
+                                   } else {
+                                       sender("INVAILD");
+                                   }
+                               });
+    cmdHandler.registerCommand(
+        "layer", "Get/set overlay layers",
+        [](SenderFunc sender, int argc, char *argv[]) {
+            if (argc <= 1) {
+                DynamicJsonDocument doc(512);
+                JsonArray array = doc.to<JsonArray>();
+                compositor.writeToJSON(array);
+                String str;
+                serializeJson(doc, str);
+                sender(str.c_str());
+                return;
+            }
+            int index = atoi(argv[1]);
+            if (index < 0 || index >= compositor.size() || argc <= 2) {
+                sender("INVAILD");
+                return;
+            }
+            if (strcmp(argv[2], "off") == 0) {
+                compositor.clear(light, index);
+                sender("OK");
+                return;
+            }
+            BlendMode mode = str2blend(argv[2]);
+            int opacity = argc > 3 ? atoi(argv[3]) : 255;
+            EffectType type = argc > 4 ? str2effect(argv[4]) : EFFECT_TYPE_COUNT;
+            if (mode < BLEND_MODE_COUNT && opacity >= 0 && opacity <= 255 &&
+                type >= CONSTANT && type < EFFECT_TYPE_COUNT) {
+                if (compositor.set(light, index,
+                                   Effect<LIGHT_TYPE>::create(type, argc - 5, (const char **)argv + 5),
+                                   mode, (uint8_t)opacity)) {
+                    sender("OK");
+                } else {
+                    sender("ERR"); // 内存不足
+                }
+            } else {
+                sender("INVAILD");
+            }
+        });
+    cmdHandler.registerCommand(
+        "segment", "Get/set segments",
+        [](SenderFunc sender, int argc, char *argv[]) {
+            if (argc <= 1) {
+                DynamicJsonDocument doc(768);
+                JsonArray array = doc.to<JsonArray>();
+                segments.writeToJSON(array);
+                String str;
+                serializeJson(doc, str);
+                sender(str.c_str());
+                return;
+            }
+            int index = atoi(argv[1]);
+            if (index < 0 || index >= segments.size() || argc <= 2) {
+                sender("INVAILD");
+                return;
+            }
+            if (strcmp(argv[2], "off") == 0) {
+                if (segments.clear(index)) {
+                    frameStats.ready = true; // 重新输出以显示底层灯效
+                }
+                sender("OK");
+                return;
+            }
+            if (strcmp(argv[2], "brightness") == 0) {
+                int brightness = argc > 3 ? atoi(argv[3]) : -1;
+                if (!segments.at(index).effect.empty() && brightness >= 0 && brightness <= 255) {
+                    segments.setBrightness(index, brightness);
+                    sender("OK");
+                } else {
+                    sender("INVAILD");
+                }
+                return;
+            }
+            int start = argc > 3 ? atoi(argv[3]) : -1;
+            int length = argc > 4 ? atoi(argv[4]) : 0;
+            EffectType type = argc > 5 ? str2effect(argv[5]) : EFFECT_TYPE_COUNT;
+            if (type >= CONSTANT && type < EFFECT_TYPE_COUNT &&
+                segments.set(light, index, argv[2], start, length,
+                             Effect<LightSegment>::create(type, argc - 6, (const char **)argv + 6))) {
+                sender("OK");
+            } else {
+                sender("INVAILD");
+            }
+        });
+    cmdHandler.registerCommand(
+        "layout", "Get/set LED topology, applied after reboot",
+        [](SenderFunc sender, int argc, char *argv[]) {
+            LIGHT_TYPE &base = light;
+            StaticJsonDocument<1024> doc;
+            if (argc <= 1) {
+                doc["configurable"] = layout_to_json(base, doc);
+                String str;
+                serializeJson(doc, str);
+                sender(str.c_str());
+                return;
+            }
+            doc["type"] = argv[1];
+            switch (str2layout(argv[1])) {
+                case LAYOUT_STRIP: // layout,strip,<count>[,<reverse>]
+                    doc["count"] = argc > 2 ? atoi(argv[2]) : 0;
+                    doc["reverse"] = argc > 3 && atoi(argv[3]) != 0;
+                    break;
+                case LAYOUT_PANEL: // layout,panel,<width>,<height>,<arrangement>
+                    doc["width"] = argc > 2 ? atoi(argv[2]) : 0;
+                    doc["height"] = argc > 3 ? atoi(argv[3]) : 0;
+                    doc["arrangement"] = argc > 4 ? atoi(argv[4]) : 0;
+                    break;
+                case LAYOUT_DISC: { // layout,disc,<arrangement>,<ring0>,<ring1>,...
+                    doc["arrangement"] = argc > 2 ? atoi(argv[2]) : 0;
+                    JsonArray rings = doc.createNestedArray("rings");
+                    for (int i = 3; i < argc; i++) {
+                        rings.add(atoi(argv[i]));
+                    }
+                    break;
+                }
+                default:
+                    break;
+            }
+            if (layout_count(base, doc) == 0) {
+                sender("INVAILD");
+                return;
+            }
+            File file = LittleFS.open(LAYOUT_FILE, "w");
+            if (file && serializeJson(doc, file)) {
+                sender("OK");
+            } else {
+                sender("ERR");
+            }
+            file.close();
+        });
     cmdHandler.registerCommand("brightness", "Get/set brightness",
                                [](SenderFunc sender, int argc, char *argv[]) {
                                    if (argc <= 1) {
@@ -453,10 +681,7 @@ void registerCommands() {
                                    int rate = atoi(argv[1]);
                                    if (rate > 0 && rate <= 400) {
                                        if (config.refreshRate != rate) {
-                                           if (timer.active())
-                                               timer.detach();
-                                           timer.attach_ms(1000 / rate,
-                                                           updateLight);
+                                           scheduler.setRate(rate);
                                            config.refreshRate = (uint16_t)rate;
                                            markDirty();
                                        }
@@ -470,8 +695,16 @@ void registerCommands() {
 ADC_MODE(ADC_VCC); // Enable ESP.getVcc()
 
 void setup() {
-    FastLED.addLeds<LED_TYPE, LED_DATA_PIN, LED_COLOR_ORDER>(light.data(),
+    LittleFS.begin();
+    load_layout(static_cast<LIGHT_TYPE &>(light), LAYOUT_FILE); // 灯珠数需在注册输出前确定
+#ifdef LED_OUTPUT_COUNT
+    static_assert(LIGHT_TYPE::outputs() == LED_OUTPUT_COUNT, "LED_OUTPUT_COUNT mismatch!");
+    FastLED.addLeds<WS2811_PORTA, LED_OUTPUT_COUNT, LED_COLOR_ORDER>(light.front(),
+                                                                   LIGHT_TYPE::countPerOutput());
+#else
+    FastLED.addLeds<LED_TYPE, LED_DATA_PIN, LED_COLOR_ORDER>(light.front(),
                                                              light.count());
+#endif
 #ifdef LED_CORRECTION
     FastLED.setCorrection(CRGB(LED_CORRECTION));
 #endif
@@ -490,7 +723,6 @@ void setup() {
     gdbstub_init(); // XXX 在 esp8266-arduino 3.0+ 上疑似会严重干扰 LED 时序
 #endif
 
-    LittleFS.begin();
     readSettings();
 
     WiFi.persistent(false);
@@ -503,7 +735,6 @@ void setup() {
     }
     WiFi.hostname(config.hostname);
 
-    initEffects();
     registerCommands();
     Serial.println(F("Start DNS server"));
     dnsServer.setErrorReplyCode(DNSReplyCode::NoError);
@@ -526,6 +757,13 @@ void setup() {
             [](const char *msg) { webServer.send(200, MIME_TYPE(json), msg); },
             "status");
     });
+#ifdef ENABLE_PROFILER
+    webServer.on("/perf", HTTP_GET, []() {
+        cmdHandler.parseCommand(
+            [](const char *msg) { webServer.send(200, MIME_TYPE(json), msg); },
+            "perf");
+    });
+#endif
     webServer.on("/config", HTTP_GET, []() {
         cmdHandler.parseCommand(
             [](const char *msg) { webServer.send(200, MIME_TYPE(json), msg); },
@@ -570,29 +808,75 @@ void setup() {
         webServer.streamFile(file, FPSTR(MIME_TYPE(none)));
         file.close();
     });
+    static int uploadStatus;   // 上传结束时返回的状态码
+    static String uploadError; // 上传出错时返回给客户端的原因
+    // 出错时只记录原因, 由上传结束后的回调统一回复一次
     webServer.on("/upload", HTTP_POST, []() {
-        webServer.send(200, MIME_TYPE(txt), PSTR("OK"));
+        if (uploadStatus != 200) {
+            webServer.send(uploadStatus, MIME_TYPE(txt), uploadError);
+        } else {
+            webServer.send(200, MIME_TYPE(txt), PSTR("OK"));
+        }
     }, []() {
         static File uploadFile;
+        static String uploadPath;
+        static AnimTranscoder transcoder; // CSV 动画在上传时转换为二进制格式, 播放时无需解析文本
+        static bool transcoding;
         HTTPUpload &upload = webServer.upload();
         if (upload.status == UPLOAD_FILE_START) {
-            String path = webServer.arg("path") + "/" + upload.filename;
-            uploadFile = LittleFS.open(path, "w");
-            if (!uploadFile) {
-                webServer.send(500, MIME_TYPE(txt), PSTR("Internal server error"));
-                return;
+            uploadPath = webServer.arg("path") + "/" + upload.filename;
+            uploadStatus = 200;
+            uploadError = "";
+            transcoding = uploadPath.startsWith("/animations/") && uploadPath.endsWith(".csv");
+            if (transcoding) {
+                uploadPath = uploadPath.substring(0, uploadPath.length() - 4) + ".anim";
+                if (!transcoder.begin(LittleFS.open(uploadPath, "w"), light.count(), webServer.arg("fps").toInt())) {
+                    transcoder.abort();
+                    LittleFS.remove(uploadPath);
+                    uploadStatus = 500;
+                    uploadError = transcoder.error();
+                    Serial.printf_P(PSTR("Transcode failed: %s\n"), transcoder.error());
+                    return;
+                }
+            } else {
+                uploadFile = LittleFS.open(uploadPath, "w");
+                if (!uploadFile) {
+                    uploadStatus = 500;
+                    uploadError = F("Internal server error");
+                    return;
+                }
             }
-            Serial.printf_P(PSTR("Upload started, file: %s\n"), path.c_str());
+            Serial.printf_P(PSTR("Upload started, file: %s\n"), uploadPath.c_str());
         } else if (upload.status == UPLOAD_FILE_WRITE) {
-            if (uploadFile) {
+            if (transcoding) {
+                if (!transcoder.failed() && !transcoder.write(upload.buf, upload.currentSize)) {
+                    transcoder.abort();
+                    LittleFS.remove(uploadPath);
+                    uploadStatus = 400;
+                    uploadError = transcoder.error();
+                    Serial.printf_P(PSTR("Transcode failed: %s\n"), transcoder.error());
+                }
+            } else if (uploadFile) {
                 if (uploadFile.write(upload.buf, upload.currentSize) != upload.currentSize) {
-                    webServer.send(500, MIME_TYPE(txt), PSTR("Internal server error"));
+                    uploadFile.close();
+                    LittleFS.remove(uploadPath);
+                    uploadStatus = 500;
+                    uploadError = F("Internal server error");
                     return;
                 }
             }
             Serial.printf_P(PSTR("Uploading, size: %u\n"), upload.currentSize);
         } else if (upload.status == UPLOAD_FILE_END) {
-            if (uploadFile) {
+            if (transcoding && !transcoder.failed()) { // 出错时已删除文件
+                if (transcoder.end()) {
+                    Serial.printf_P(PSTR("Transcoded %u frames\n"), transcoder.frames());
+                } else {
+                    LittleFS.remove(uploadPath);
+                    uploadStatus = 400;
+                    uploadError = transcoder.error();
+                    Serial.printf_P(PSTR("Transcode failed: %s\n"), transcoder.error());
+                }
+            } else if (!transcoding && uploadFile) {
                 uploadFile.close();
             }
             Serial.printf_P(PSTR("Upload finished, size: %u\n"), upload.totalSize);
@@ -662,6 +946,7 @@ void setup() {
                 break;
             }
             case WStype_TEXT: {
+                PERF_SCOPE(PERF_WEBSOCKET);
                 char *str = (char *)payload;
                 if (length > 0) {
 #ifdef ENABLE_DEBUG
@@ -691,11 +976,21 @@ void setup() {
     }
 }
 
-void loop() {
+void saveSettingsIfDirty() {
+#if ANIM_RESUME_SAVE_PERIOD > 0
+    // 播放位置不会标记配置为已修改, 播放动画时定期保存
+    if (!config.isDirty && lightEffect.type() == ANIMATION && lightEffect.as<AnimationEffect>().seekable() &&
+        millis() - config.lastModifyTime >= ANIM_RESUME_SAVE_PERIOD) {
+        markDirty();
+    }
+#endif
     if (config.isDirty &&
         millis() - config.lastModifyTime >= CONFIG_SAVE_PERIOD) {
         saveSettings();
     }
+}
+
+void handleSerial() {
     while (Serial.available() > 0) {
         char buffer[128];
         size_t len = Serial.readBytesUntil('\n', buffer, sizeof(buffer) - 1);
@@ -708,10 +1003,45 @@ void loop() {
             yield();
         }
     }
-    dnsServer.processNextRequest();
-    webServer.handleClient();
-    wsServer.loop();
-    MDNS.update();
+}
+
+// 服务最多连续推迟的帧数, 超过后无论剩余时间都执行一次, 以免在高刷新率下饿死
+#define SERVICE_MAX_DEFER_FRAMES 8
+
+struct Service {
+    void (*poll)();
+    uint32_t budget; // 预计耗时 (us), 距离下一帧不足此时间时推迟执行, 需小于帧周期
+    uint32_t frame;  // 上次执行时的帧序号
+};
+
+Service services[] = {
+    {saveSettingsIfDirty, 8000, 0}, // 保存配置可能较慢, 只在帧间空闲较多时执行
+    {handleSerial, 500, 0},
+    {AnimPlayer::pollAll, 3000, 0}, // 空闲时预读动画帧
+    {[]() { dnsServer.processNextRequest(); }, 500, 0},
+    {[]() { webServer.handleClient(); }, 5000, 0},
+    {[]() { wsServer.loop(); }, 2000, 0},
+    {[]() { MDNS.update(); }, 500, 0},
+};
+
+void loop() {
+    uint32_t now = micros();
+    if (scheduler.due(now)) {
+        uint32_t deadline = scheduler.nextDeadline();
+        scheduler.next(now);
+        presentFrame(deadline);
+    } else if (frameStats.frame != scheduler.frames()) {
+        frameStats.frame = scheduler.frames();
+        renderFrame();
+    }
+    for (Service &service : services) {
+        // 时间不足时推迟到下一帧之后, 连续推迟过多帧时才占用渲染时间
+        if (scheduler.defer(micros(), service.budget, service.frame, SERVICE_MAX_DEFER_FRAMES)) {
+            continue;
+        }
+        service.frame = scheduler.frames();
+        service.poll();
+    }
 }
 
 #ifdef ENABLE_DEBUG
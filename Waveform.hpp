@@ -0,0 +1,103 @@
+#ifndef __WAVEFORM_HPP__
+#define __WAVEFORM_HPP__
+
+#include <Arduino.h>
+#include <FastLED.h>
+
+enum WaveShape {
+    WAVE_SQUARE,   // 方波, 亮起时为最大值
+    WAVE_TRIANGLE, // 三角波
+    WAVE_PARABOLA, // 抛物线, 4x(1-x)
+    WAVE_SINE,     // 升余弦
+    WAVE_EASE,     // 二次缓入缓出的三角波
+    WAVE_CUSTOM,   // 自定义曲线, 256 项 PROGMEM 查找表
+};
+
+/**
+ * @brief Fixed-point periodic envelope
+ *
+ * Each period has an "on" part, where the shape is played from start to end,
+ * followed by an "off" part at level 0. The clock counts microseconds within
+ * the period, and is converted to a Q16 phase of the "on" part by a multiply
+ * with a precomputed reciprocal, so advancing needs no floating point and no
+ * division except when the frame is longer than a whole period.
+ */
+class Waveform {
+private:
+    WaveShape shape;
+    const uint8_t *curve; // WAVE_CUSTOM 的查找表
+    uint32_t currentTime; // 周期内的时间 (us)
+    uint32_t onTime;      // 亮起部分的时长 (us)
+    uint32_t period;      // 周期 (us), 至少为 1
+    uint32_t scale;       // 2^32 / onTime, 把亮起部分的时间换算为 Q16 相位
+
+    static uint8_t triangle(uint16_t x) {
+        return x < 0x8000 ? x >> 7 : (0xFFFF - x) >> 7;
+    }
+
+public:
+    Waveform(WaveShape shape, uint32_t onTime, uint32_t offTime, const uint8_t *curve = nullptr) :
+        shape(shape), curve(curve), currentTime(0) {
+        setTiming(onTime, offTime);
+    }
+
+    /**
+     * @brief Change the timing, keeping the clock within the period
+     *
+     * @param onTime duration of the shape in microseconds
+     * @param offTime duration of level 0 after the shape in microseconds
+     */
+    void setTiming(uint32_t onTime, uint32_t offTime) {
+        this->onTime = onTime;
+        this->period = std::max<uint32_t>(onTime + offTime, 1);
+        this->scale = onTime > 1 ? (uint32_t) ((1ull << 32) / onTime) : UINT32_MAX;
+        currentTime %= period;
+    }
+
+    // 亮起部分内的 Q16 相位, 熄灭部分返回 0
+    uint16_t phase() const {
+        return on() ? ((uint64_t) currentTime * scale) >> 16 : 0;
+    }
+
+    bool on() const {
+        return currentTime < onTime;
+    }
+
+    uint8_t level() const {
+        if (!on()) {
+            return 0;
+        }
+        uint16_t x = phase();
+        switch (shape) {
+            case WAVE_SQUARE:
+                return 255;
+            case WAVE_TRIANGLE:
+                return triangle(x);
+            case WAVE_PARABOLA:
+                return std::min<uint32_t>(((uint32_t) x * (0x10000 - x)) >> 22, 255);
+            case WAVE_SINE:
+                return 255 - cos8(x >> 8);
+            case WAVE_EASE:
+                return ease8InOutQuad(triangle(x));
+            case WAVE_CUSTOM:
+                return curve ? pgm_read_byte(curve + (x >> 8)) : 0;
+        }
+        return 0;
+    }
+
+    /**
+     * @brief Advance the clock and get the level at the new time
+     *
+     * @param deltaTime time since last frame in microseconds
+     * @return uint8_t level (0-255)
+     */
+    uint8_t advance(uint32_t deltaTime) {
+        currentTime += deltaTime;
+        if (currentTime >= period) {
+            currentTime %= period;
+        }
+        return level();
+    }
+};
+
+#endif // __WAVEFORM_HPP__
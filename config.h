@@ -25,14 +25,33 @@
 #define LIGHT_TYPE LightStrip<30, false>
 // #define LIGHT_TYPE LightDisc<CLOCKWISE | OUTSIDE_IN, 12, 6, 3>
 // #define LIGHT_TYPE LightPanel<16, 16, Z_WORD | HORIZONTAL>
+// #define LIGHT_TYPE PackedCube<16, 16, 16, Rgb565> // 渲染缓冲为 RGB565, 只有输出缓冲为 CRGB, 省下 4 KB
+// #define LIGHT_TYPE LightLayout<512> // 形态在启动时从 LAYOUT_FILE 读取, 无需重新编译, 512 为最多灯珠数
+// 运行时形态的配置文件, 可通过 layout 命令修改, 重启后生效
+#define LAYOUT_FILE "/layout.json"
+// LED 灯并行输出路数(可选), 使用 GPIO12~15 同时输出, 此时 LED_DATA_PIN 无效, LIGHT_TYPE 需为对应路数的 MultiOutput, 仅支持灯带和灯板
+// #define LED_OUTPUT_COUNT 4
+// #define LIGHT_TYPE MultiOutput<LightPanel<16, 16, SNAKE | HORIZONTAL>, LightPanel<16, 4, SNAKE | HORIZONTAL>, 4>
 
 /****************************** 软件配置 ******************************/
 // 开启调试模式
 // #define ENABLE_DEBUG
+// 开启性能统计, 可通过 perf 命令查看各阶段耗时, 关闭时不产生任何开销
+// #define ENABLE_PROFILER
 // 给你的炫酷小彩灯起个名字吧, 会影响 WIFI 热点名称和网页/小程序的显示
 #define NAME "RGBLight"
 // 多少毫秒不修改配置后保存配置, 0 为每次修改后立刻保存 (建议不要设为 0, 会大大缩短 Flash 寿命)
 #define CONFIG_SAVE_PERIOD (10 * 1000)
+// 最多可叠加的灯效图层数, 每个启用的图层额外占用一帧的内存, 有图层时底层灯效也需要一帧, 未启用时不占用
+#define MAX_LAYER_COUNT 2
+// 最多可划分的分段数, 有分段时所有分段共用一帧的内存, 未启用时不占用
+#define MAX_SEGMENT_COUNT 4
+// 二进制动画预读的帧数, 在空闲时解码, 刷新时只需复制, 0 为不预读; 内存不足时自动减少
+#define ANIM_PREFETCH_FRAMES 4
+// 预读时至少保留的空闲内存 (字节)
+#define ANIM_PREFETCH_HEAP_RESERVE 8192
+// 播放二进制动画时每隔多少毫秒保存一次播放位置, 重启后从最近保存的位置继续, 0 为只在修改配置时保存
+#define ANIM_RESUME_SAVE_PERIOD (10 * 60 * 1000)
 
 // 恭喜你, 已经完成了所有配置, 其余配置可通过网页或小程序修改, 详见 README.md
 
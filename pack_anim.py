@@ -0,0 +1,171 @@
+#!/usr/bin/env python3
+# coding=utf-8
+
+from enum import IntEnum
+import argparse
+import os
+import struct
+
+ANIM_MAGIC = b"ANIM"
+ANIM_VERSION = 1
+ANIM_INDEX_MAGIC = b"INDX"
+
+class AnimFormat(IntEnum):
+    RGB = 0
+    RLE = 1
+    PALETTE_RLE = 2
+
+class AnimFrameType(IntEnum):
+    KEYFRAME = 0
+    DELTA = 1
+
+# 行程标记, 低位为长度减一, 详见 Animation.hpp
+ANIM_LITERAL = 0x00
+ANIM_REPEAT = 0x80
+ANIM_SKIP = 0xC0
+MAX_LITERAL = 128
+MAX_RUN = 64
+
+class AnimHeader:
+    def __init__(self, format, fps, led_count, palette_size, frame_count):
+        self.magic = ANIM_MAGIC
+        self.version = ANIM_VERSION
+        self.format = format
+        self.fps = fps
+        self.led_count = led_count
+        self.palette_size = palette_size
+        self.frame_count = frame_count
+
+    def pack(self):
+        return struct.pack("<4sBBHHHI", self.magic, self.version, self.format,
+                           self.fps, self.led_count, self.palette_size, self.frame_count)
+
+def parse_csv(path):
+    """读取 CSV 动画, 每行一帧, 每个元素为 #RRGGBB"""
+    frames = []
+    with open(path, "r", encoding="utf-8") as file:
+        for line_no, line in enumerate(file, 1):
+            line = line.strip()
+            if not line:
+                continue
+            frame = []
+            for element in line.split(","):
+                element = element.strip()
+                if len(element) != 7 or element[0] != "#":
+                    raise ValueError(f"{path}:{line_no}: 无效的颜色 {element!r}")
+                frame.append(bytes.fromhex(element[1:]))
+            frames.append(frame)
+    return frames
+
+def run_length(pixels, start, limit):
+    """从 start 起与 pixels[start] 相同的像素数"""
+    end = start + 1
+    while end < len(pixels) and end - start < limit and pixels[end] == pixels[start]:
+        end += 1
+    return end - start
+
+def skip_length(pixels, previous, start):
+    """从 start 起与上一帧相同的像素数"""
+    if previous is None:
+        return 0
+    end = start
+    while end < len(pixels) and end - start < MAX_RUN and pixels[end] == previous[end]:
+        end += 1
+    return end - start
+
+def encode_frame(pixels, previous):
+    """编码一帧, previous 为 None 时编码为关键帧"""
+    out = bytearray([AnimFrameType.KEYFRAME if previous is None else AnimFrameType.DELTA])
+    literal = []
+
+    def flush_literal():
+        while literal:
+            chunk = literal[:MAX_LITERAL]
+            del literal[:MAX_LITERAL]
+            out.append(ANIM_LITERAL | (len(chunk) - 1))
+            for pixel in chunk:
+                out.extend(pixel)
+
+    i = 0
+    while i < len(pixels):
+        skip = skip_length(pixels, previous, i)
+        run = run_length(pixels, i, MAX_RUN)
+        # 单个像素的行程不比字面量短, 跳过和重复至少需要 2 个像素才划算
+        if skip >= 2 or (skip == 1 and not literal):
+            flush_literal()
+            out.append(ANIM_SKIP | (skip - 1))
+            i += skip
+        elif run >= 2:
+            flush_literal()
+            out.append(ANIM_REPEAT | (run - 1))
+            out.extend(pixels[i])
+            i += run
+        else:
+            literal.append(pixels[i])
+            i += 1
+    flush_literal()
+    return bytes(out)
+
+def encode(frames, led_count, fps, compress, palette_mode, keyframe_interval):
+    frames = [frame + [b"\x00\x00\x00"] * (led_count - len(frame)) for frame in frames]
+    if not compress:
+        header = AnimHeader(AnimFormat.RGB, fps, led_count, 0, len(frames))
+        return header.pack() + b"".join(b"".join(frame) for frame in frames)
+
+    colors = sorted({pixel for frame in frames for pixel in frame})
+    palette = b""
+    if palette_mode and len(colors) <= 256:
+        index = {color: bytes([i]) for i, color in enumerate(colors)}
+        frames = [[index[pixel] for pixel in frame] for frame in frames]
+        palette = b"".join(colors)
+        format = AnimFormat.PALETTE_RLE
+    else:
+        format = AnimFormat.RLE
+
+    header = AnimHeader(format, fps, led_count, len(palette) // 3, len(frames))
+    data = bytearray(header.pack() + palette)
+    offsets = []
+    previous = None
+    for i, frame in enumerate(frames):
+        # 首帧必须为关键帧, 此后每隔 keyframe_interval 帧插入一个关键帧
+        keyframe = i == 0 or (keyframe_interval > 0 and i % keyframe_interval == 0)
+        if keyframe:
+            offsets.append(len(data))
+        data += encode_frame(frame, None if keyframe else previous)
+        previous = frame
+    if keyframe_interval > 0:
+        # 关键帧索引, 用于跳转到任意帧
+        data += struct.pack(f"<{len(offsets)}I", *offsets)
+        data += struct.pack("<4sHHI", ANIM_INDEX_MAGIC, keyframe_interval, 0, len(offsets))
+    return bytes(data)
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="将 CSV 动画转换为二进制动画")
+    parser.add_argument("csv", help="CSV 动画")
+    parser.add_argument("output", nargs="?", help="输出文件, 默认为同名的 .anim 文件")
+    parser.add_argument("fps", nargs="?", type=int, default=0, help="帧率, 0 为每次刷新播放一帧")
+    parser.add_argument("--raw", action="store_true", help="不压缩, 每帧只需一次读取")
+    parser.add_argument("--no-palette", action="store_true", help="不超过 256 色时也不使用调色板")
+    parser.add_argument("--keyframe", type=int, default=30,
+                        help="关键帧间隔, 跳转时最多需解码这么多帧, 0 为仅首帧且不生成索引")
+    args = parser.parse_args()
+
+    anim_path = args.output or os.path.splitext(args.csv)[0] + ".anim"
+    try:
+        frames = parse_csv(args.csv)
+    except ValueError as e:
+        print(e)
+        exit(1)
+    if not frames:
+        print(f"{args.csv} 中没有帧")
+        exit(1)
+
+    # 每帧灯珠数取最长的一行, 较短的行补黑色
+    led_count = max(len(frame) for frame in frames)
+    data = encode(frames, led_count, args.fps, not args.raw, not args.no_palette, args.keyframe)
+    with open(anim_path, "wb") as file:
+        file.write(data)
+    format = AnimFormat(data[5]).name
+    raw_size = 16 + len(frames) * led_count * 3
+    print(f"{args.csv} -> {anim_path}, {len(frames)} 帧, 每帧 {led_count} 个灯珠, 格式 {format}, "
+          f"{os.path.getsize(args.csv)} -> {len(data)} 字节, 压缩率 {raw_size / len(data):.2f}x (相对未压缩)")
@@ -0,0 +1,22 @@
+#include "test.h"
+
+#include "LightEffect.hpp"
+
+// 256 灯珠, 1000 帧, 每次刷新播放一帧
+static double frames_per_second(const char *name) {
+    static LightStrip<256, false> light;
+    const int FRAMES = 5000;
+    AnimationEffect effect(name);
+    int played = 0;
+    uint64_t start = test_nanos();
+    for (int i = 0; i < FRAMES; i++) {
+        played += effect.update(light, 16666);
+    }
+    return played * 1e9 / (test_nanos() - start);
+}
+
+// 主机上文件读取由操作系统缓存, 设备上逐字节读取的开销更大
+TEST(animation_frames_per_second) {
+    test_report("CSV, byte reads", frames_per_second("panel.csv"), "frames/s");
+    test_report("binary, block reads", frames_per_second("panel.anim"), "frames/s");
+}
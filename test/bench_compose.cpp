@@ -0,0 +1,30 @@
+#include "test.h"
+
+#include "LightCompositor.hpp"
+
+template <typename Light>
+static void bench_layers(const char *name) {
+    const int FRAMES = 20000;
+    const BlendMode modes[] = {BLEND_ADD, BLEND_ALPHA, BLEND_MAX, BLEND_MULTIPLY, BLEND_MASK};
+    char label[64];
+    for (BlendMode mode : modes) {
+        Light out;
+        Compositor<Light, 2> compositor;
+        const char *args[] = {"5"};
+        compositor.set(out, 0, RainbowEffect::fromArgs(1, args), mode, 128);
+        compositor.set(out, 1, RainbowEffect::fromArgs(1, args), mode, 128);
+        uint64_t start = test_nanos();
+        for (int i = 0; i < FRAMES; i++) {
+            compositor.compose(out, true, 16666);
+        }
+        double ns = (double) (test_nanos() - start) / FRAMES / 2;
+        snprintf(label, sizeof(label), "%s %s", name, blend2str(mode));
+        test_report(label, ns, "ns/layer");
+    }
+}
+
+// 每层耗时包含该层灯效的更新和混合
+TEST(compose_cost_per_layer) {
+    bench_layers<LightStrip<30, false>>("strip 30");
+    bench_layers<LightPanel<16, 16, Z_WORD | HORIZONTAL>>("panel 16x16");
+}
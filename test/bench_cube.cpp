@@ -0,0 +1,71 @@
+#include "test.h"
+
+#include "CubeRenderer.hpp"
+
+static const int N = 16;
+
+template <int X, int Y, int Z>
+static void clear_scene(LightCube<X, Y, Z> &cube) {
+    fill_solid(cube.data(), cube.count(), CRGB(0, 0, 0));
+}
+
+template <int X, int Y, int Z, typename Format>
+static void clear_scene(PackedCube<X, Y, Z, Format> &cube) {
+    cube.clear();
+}
+
+// 雨滴: 每列一个下落的光点, 每帧清屏重绘
+template <typename Cube>
+static void rain(Cube &cube, int frame, typename Cube::color_type color) {
+    clear_scene(cube);
+    for (int y = 0; y < N; y++) {
+        for (int x = 0; x < N; x++) {
+            int z = N - 1 - (frame + x * 7 + y * 13) % N;
+            cube.set(x, y, z, color);
+        }
+    }
+}
+
+// 旋转平面: 绕 z 轴转动的竖直平面, 每层画一条过中心的线
+template <typename Cube>
+static void rotating_plane(Cube &cube, int frame, typename Cube::color_type color) {
+    clear_scene(cube);
+    int step = frame % (2 * (N - 1));
+    int a = step < N ? step : 0, b = step < N ? N - 1 : step - N + 1;
+    for (int z = 0; z < N; z++) {
+        drawLine(cube, a, b, z, N - 1 - a, N - 1 - b, z, color);
+    }
+}
+
+static const int FRAMES = 2000;
+
+// 每帧绘制后 swap 到输出缓冲: LightCube 为复制, PackedCube 为展开
+template <typename Cube, typename Scene>
+static double frame_ns(DoubleBuffer<Cube> &light, Scene scene, typename Cube::color_type color) {
+    uint64_t start = test_nanos();
+    for (int i = 0; i < FRAMES; i++) {
+        scene(light, i, color);
+        light.swap();
+    }
+    return (double) (test_nanos() - start) / FRAMES;
+}
+
+TEST(cube_scene_cost) {
+    typedef LightCube<N, N, N> Cube;
+    typedef PackedCube<N, N, N, Rgb565> Cube565;
+    typedef PackedCube<N, N, N, Palette8> CubePalette;
+    static DoubleBuffer<Cube> cube;
+    static DoubleBuffer<Cube565> packed;
+    static DoubleBuffer<CubePalette> palette;
+    palette.format.palette[1] = CRGB(0, 255, 0);
+
+    test_report("rain, LightCube", frame_ns(cube, rain<Cube>, CRGB(0, 255, 0)), "ns/frame");
+    test_report("rain, Rgb565", frame_ns(packed, rain<Cube565>, CRGB(0, 255, 0)), "ns/frame");
+    test_report("rain, Palette8", frame_ns(palette, rain<CubePalette>, 1), "ns/frame");
+    test_report("plane, LightCube", frame_ns(cube, rotating_plane<Cube>, CRGB(0, 255, 0)), "ns/frame");
+    test_report("plane, Rgb565", frame_ns(packed, rotating_plane<Cube565>, CRGB(0, 255, 0)), "ns/frame");
+    test_report("plane, Palette8", frame_ns(palette, rotating_plane<CubePalette>, 1), "ns/frame");
+    test_report("render + output, LightCube", sizeof(cube), "bytes");
+    test_report("render + output, Rgb565", sizeof(packed), "bytes");
+    test_report("render + output, Palette8", sizeof(palette), "bytes");
+}
@@ -0,0 +1,56 @@
+#include "test.h"
+
+#include "Animation.hpp"
+
+static const char *const VARIANTS[] = {"", "_rle", "_palette", "_intra", "_noindex"};
+
+static uint32_t file_size(const String &path) {
+    File file = LittleFS.open(path, "r");
+    return file ? file.size() : 0;
+}
+
+// 顺序读取/解码整个动画若干遍, 返回每帧耗时
+static double decode_ns(const String &path) {
+    static CRGB leds[256];
+    File file = LittleFS.open(path, "r");
+    AnimHeader header;
+    AnimDecoder decoder;
+    if (!read_anim_header(file, header) || (header.compressed() && !decoder.begin(file, header))) {
+        return 0;
+    }
+    const int PASSES = 20;
+    uint64_t start = test_nanos();
+    for (int pass = 0; pass < PASSES; pass++) {
+        if (header.compressed()) {
+            decoder.seek(file, 0);
+        } else {
+            file.seek(header.dataOffset());
+        }
+        for (uint32_t i = 0; i < header.frameCount; i++) {
+            bool success = header.compressed() ? decoder.decode(file, leds, 256)
+                                               : read_anim_frame(file, header, leds, 256);
+            if (!success) {
+                return 0;
+            }
+        }
+    }
+    return (double) (test_nanos() - start) / PASSES / header.frameCount;
+}
+
+static void bench_animation(const char *name) {
+    char label[64];
+    uint32_t raw = file_size(String("/animations/") + name + ".anim");
+    for (const char *variant : VARIANTS) {
+        String path = String("/animations/") + name + variant + ".anim";
+        snprintf(label, sizeof(label), "%s%s, ratio to raw", name, variant);
+        test_report(label, (double) raw / file_size(path), "x");
+        snprintf(label, sizeof(label), "%s%s, decode", name, variant);
+        test_report(label, decode_ns(path), "ns/frame");
+    }
+}
+
+// 压缩率相对于未压缩的二进制动画, CSV 约为其 2.7 倍
+TEST(decoder_ratio_and_cost) {
+    bench_animation("example");
+    bench_animation("panel");
+}
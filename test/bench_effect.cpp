@@ -0,0 +1,31 @@
+#include "test.h"
+
+#include "LightEffect.hpp"
+
+typedef LightStrip<30, false> Strip;
+
+static const int FRAMES = 1000000;
+
+// 每帧经 Effect 分发与直接调用灯效的耗时之差即为分发开销
+TEST(effect_dispatch) {
+    Strip light;
+    const char *args[] = {"5", "0"};
+    RainbowEffect direct = RainbowEffect::fromArgs(2, args);
+    Effect<Strip> effect = RainbowEffect::fromArgs(2, args);
+
+    uint64_t start = test_nanos();
+    for (int i = 0; i < FRAMES; i++) {
+        direct.update(light, 16666);
+    }
+    double directNs = (double) (test_nanos() - start) / FRAMES;
+
+    start = test_nanos();
+    for (int i = 0; i < FRAMES; i++) {
+        effect.update(light, 16666);
+    }
+    double dispatchNs = (double) (test_nanos() - start) / FRAMES;
+
+    test_report("rainbow direct", directNs, "ns/frame");
+    test_report("rainbow through Effect", dispatchNs, "ns/frame");
+    test_report("dispatch overhead", dispatchNs - directNs, "ns/frame");
+}
@@ -0,0 +1,65 @@
+#include "test.h"
+
+#include "LightEffect.hpp"
+#include "LightLayout.hpp"
+
+typedef LightLayout<512> Layout;
+
+template <typename Light>
+static double run_ns(Light &light, StreamEffect &stream) {
+    const int FRAMES = 20000;
+    uint64_t start = test_nanos();
+    for (int i = 0; i < FRAMES; i++) {
+        stream.update(light, 16666 * 4); // 每帧色相都变化, 每帧都重新绘制
+    }
+    return (double) (test_nanos() - start) / FRAMES;
+}
+
+// 运行时形态查表访问灯珠, 与编译期形态对比每帧耗时
+// 两者交替运行多轮, 各取最快的一轮, 减少主机上调度和频率变化的干扰
+template <typename Fixed>
+static void bench_topology(JsonDocument &json, const char *name) {
+    const int RUNS = 9;
+    static Layout layout;
+    static Fixed fixed;
+    char label[64];
+    Layout::readFromJSON(json);
+    for (int direction = 0; direction < 2; direction++) {
+        StreamEffect a(direction, 1), b(direction, 1);
+        double fixedNs = 1e9, layoutNs = 1e9;
+        for (int run = 0; run < RUNS; run++) {
+            fixedNs = std::min(fixedNs, run_ns(fixed, a));
+            layoutNs = std::min(layoutNs, run_ns(layout, b));
+        }
+        snprintf(label, sizeof(label), "%s, fixed, direction %d", name, direction);
+        test_report(label, fixedNs, "ns/frame");
+        snprintf(label, sizeof(label), "%s, layout, direction %d", name, direction);
+        test_report(label, layoutNs, "ns/frame");
+        snprintf(label, sizeof(label), "%s, layout / fixed, direction %d", name, direction);
+        test_report(label, layoutNs / fixedNs, "x");
+    }
+}
+
+// direction 0 按切片填充, 1 按像素坐标着色
+TEST(layout_cost_against_fixed) {
+    StaticJsonDocument<256> json;
+    json["type"] = "strip";
+    json["count"] = 30;
+    bench_topology<LightStrip<30, false>>(json, "strip 30");
+
+    json.clear();
+    json["type"] = "panel";
+    json["width"] = 16;
+    json["height"] = 16;
+    json["arrangement"] = SNAKE | VERTICAL;
+    bench_topology<LightPanel<16, 16, SNAKE | VERTICAL>>(json, "panel 16x16");
+
+    json.clear();
+    json["type"] = "disc";
+    json["arrangement"] = CLOCKWISE | OUTSIDE_IN;
+    JsonArray rings = json.createNestedArray("rings");
+    rings.add(12);
+    rings.add(6);
+    rings.add(3);
+    bench_topology<LightDisc<CLOCKWISE | OUTSIDE_IN, 12, 6, 3>>(json, "disc 12/6/3");
+}
@@ -0,0 +1,36 @@
+#include "test.h"
+
+#include "LightCompositor.hpp"
+
+typedef LightPanel<16, 16, SNAKE | HORIZONTAL> Panel;
+typedef MultiOutput<Panel, LightPanel<16, 4, SNAKE | HORIZONTAL>, 4> Multi;
+
+// 多路输出在 swap 时多一次查表重排, 与单路的 memcpy 对比
+TEST(multi_output_swap_cost) {
+    const int FRAMES = 100000;
+    static DoubleBuffer<Panel> single;
+    static DoubleBuffer<Multi> multi;
+
+    uint64_t start = test_nanos();
+    for (int i = 0; i < FRAMES; i++) {
+        single.data()[i & 255].r = i;
+        single.swap();
+    }
+    test_report("swap, single output", (double) (test_nanos() - start) / FRAMES, "ns/frame");
+
+    start = test_nanos();
+    for (int i = 0; i < FRAMES; i++) {
+        multi.data()[i & 255].r = i;
+        multi.swap();
+    }
+    test_report("swap, 4 outputs", (double) (test_nanos() - start) / FRAMES, "ns/frame");
+
+    Segments<Multi, 1> segments;
+    segments.set(multi, 0, "a", 0, 64, ConstantEffect(0xFF0000));
+    segments.update(16666);
+    start = test_nanos();
+    for (int i = 0; i < FRAMES; i++) {
+        segments.overlay(multi, multi.front());
+    }
+    test_report("overlay 64 LEDs, 4 outputs", (double) (test_nanos() - start) / FRAMES, "ns/frame");
+}
@@ -0,0 +1,76 @@
+#include "test.h"
+
+#include "Light.hpp"
+
+// 原 LightPanel::at 的逐像素计算
+template <int W, int H, int ARRANGEMENT>
+static CRGB &reference_at(CRGB *leds, int x, int y) {
+    int w = W, h = H;
+    if (ARRANGEMENT & VERTICAL) {
+        std::swap(x, y);
+        std::swap(w, h);
+    }
+    if ((ARRANGEMENT & SNAKE) && y % 2 == 1) {
+        x = w - x - 1;
+    }
+    if (ARRANGEMENT & MIRROR) {
+        x = w - x - 1;
+    }
+    if (ARRANGEMENT & FLIP) {
+        y = h - y - 1;
+    }
+    return leds[y * w + x];
+}
+
+template <int ARRANGEMENT>
+static void bench_arrangement(const char *name) {
+    typedef LightPanel<16, 16, ARRANGEMENT> Panel;
+    const int FRAMES = 50000;
+    static Panel panel;
+    char label[64];
+
+    uint64_t start = test_nanos();
+    for (int i = 0; i < FRAMES; i++) {
+        for (int y = 0; y < 16; y++) {
+            for (int x = 0; x < 16; x++) {
+                reference_at<16, 16, ARRANGEMENT>(panel.data(), x, y) = CRGB(x, y, i);
+            }
+        }
+    }
+    double before = (double) FRAMES * Panel::count() * 1e3 / (test_nanos() - start);
+
+    start = test_nanos();
+    for (int i = 0; i < FRAMES; i++) {
+        for (int y = 0; y < 16; y++) {
+            for (int x = 0; x < 16; x++) {
+                panel.at(x, y) = CRGB(x, y, i);
+            }
+        }
+    }
+    double after = (double) FRAMES * Panel::count() * 1e3 / (test_nanos() - start);
+
+    start = test_nanos();
+    for (int i = 0; i < FRAMES; i++) {
+        for (int y = 0; y < 16; y++) {
+            int x = 0;
+            for (CRGB &led : panel.row(y)) {
+                led = CRGB(x++, y, i);
+            }
+        }
+    }
+    double rows = (double) FRAMES * Panel::count() * 1e3 / (test_nanos() - start);
+
+    snprintf(label, sizeof(label), "%s, at() before", name);
+    test_report(label, before, "Mpixel/s");
+    snprintf(label, sizeof(label), "%s, at() after", name);
+    test_report(label, after, "Mpixel/s");
+    snprintf(label, sizeof(label), "%s, row spans", name);
+    test_report(label, rows, "Mpixel/s");
+}
+
+// 主机上的分支预测远好于 ESP8266, 差距以设备上为准
+TEST(panel_pixels_per_second) {
+    bench_arrangement<Z_WORD>("Z_WORD");
+    bench_arrangement<SNAKE>("SNAKE");
+    bench_arrangement<VERTICAL | MIRROR | FLIP>("VERTICAL|MIRROR|FLIP");
+}
@@ -0,0 +1,31 @@
+#include "test.h"
+
+#include "LightEffect.hpp"
+
+// 刷新时的耗时, 预读在计时之外的空闲时间进行
+static double render_ns(const char *name, bool prefetch) {
+    const int FRAMES = 5000;
+    static LightStrip<256, false> light;
+    ESP.maxFreeBlockSize = prefetch ? 20000 : 0;
+    AnimationEffect effect(name);
+    ESP.maxFreeBlockSize = 20000;
+    uint64_t total = 0;
+    for (int i = 0; i < FRAMES; i++) {
+        AnimPlayer::pollAll();
+        uint64_t start = test_nanos();
+        effect.update(light, 16666);
+        total += test_nanos() - start;
+    }
+    return (double) total / FRAMES;
+}
+
+TEST(prefetch_render_path_cost) {
+    const char *const names[] = {"panel.anim", "panel_rle.anim", "panel_palette.anim"};
+    char label[64];
+    for (const char *name : names) {
+        snprintf(label, sizeof(label), "%s, direct", name);
+        test_report(label, render_ns(name, false), "ns/frame");
+        snprintf(label, sizeof(label), "%s, prefetched", name);
+        test_report(label, render_ns(name, true), "ns/frame");
+    }
+}
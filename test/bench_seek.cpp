@@ -0,0 +1,24 @@
+#include "test.h"
+
+#include "LightEffect.hpp"
+
+// 跳转到随机位置后显示一帧的耗时, 压缩的动画需从最近的关键帧解码
+TEST(seek_random_frame_cost) {
+    const char *const names[] = {"panel.anim", "panel_rle.anim", "panel_palette.anim", "panel_noindex.anim"};
+    const int SEEKS = 2000;
+    static LightStrip<256, false> light;
+    char label[64];
+    for (const char *name : names) {
+        AnimationEffect effect(name);
+        srand(1);
+        uint64_t start = test_nanos();
+        for (int i = 0; i < SEEKS; i++) {
+            char frame[16];
+            snprintf(frame, sizeof(frame), "%d", rand() % 1000);
+            effect.set("frame", frame);
+            effect.update(light, 16666);
+        }
+        snprintf(label, sizeof(label), "%s, seek and show", name);
+        test_report(label, (double) (test_nanos() - start) / SEEKS, "ns");
+    }
+}
@@ -0,0 +1,28 @@
+#include "test.h"
+
+#include "LightEffect.hpp"
+
+template <typename Light>
+static void bench_light(const char *name) {
+    const int FRAMES = 20000;
+    static Light light;
+    char label[64];
+    for (int direction = 0; direction < 3; direction++) {
+        StreamEffect stream(direction, 1);
+        uint64_t start = test_nanos();
+        for (int i = 0; i < FRAMES; i++) {
+            stream.update(light, 16666 * 4); // 每帧色相都变化, 每帧都重新绘制
+        }
+        double ns = (double) (test_nanos() - start) / FRAMES;
+        snprintf(label, sizeof(label), "%s, stream direction %d", name, direction);
+        test_report(label, ns / light.count(), "ns/LED");
+    }
+}
+
+// direction 0 为按切片着色, 1 和 2 为按像素坐标着色
+TEST(shader_cost_per_topology) {
+    bench_light<LightStrip<30, false>>("strip 30");
+    bench_light<LightPanel<16, 16, SNAKE | VERTICAL>>("panel 16x16");
+    bench_light<LightDisc<CLOCKWISE | OUTSIDE_IN, 12, 6, 3>>("disc 12/6/3");
+    bench_light<LightCube<16, 16, 16>>("cube 16x16x16");
+}
@@ -0,0 +1,69 @@
+#include "test.h"
+
+#include "Waveform.hpp"
+
+static const int FRAMES = 10000000;
+static const int FPS = 60;
+
+static volatile uint8_t sink;
+
+// 原 BreathEffect 每帧的亮度计算, 帧率和时长为浮点数
+struct OldBreath {
+    uint16_t currentFrame = 0;
+    float lastTime = 1.0, interval = 0.5;
+
+    uint8_t update() {
+        int lastTime = FPS * this->lastTime;
+        int interval = FPS * this->interval;
+        uint8_t level = 0;
+        if (currentFrame <= lastTime) {
+            double x = (double) currentFrame / lastTime;
+            level = -1010 * x * x + 1010 * x;
+        }
+        if (++currentFrame >= lastTime + interval) {
+            currentFrame = 0;
+        }
+        return level;
+    }
+};
+
+// 原 BlinkEffect 每帧的亮灭判断
+struct OldBlink {
+    uint16_t currentFrame = 0;
+    float lastTime = 1.0, interval = 1.0;
+
+    uint8_t update() {
+        int lastTime = FPS * this->lastTime;
+        int interval = FPS * this->interval;
+        uint8_t level = currentFrame < lastTime ? 255 : 0;
+        if (++currentFrame >= lastTime + interval) {
+            currentFrame = 0;
+        }
+        return level;
+    }
+};
+
+template <typename F>
+static double time_frames(F f) {
+    uint64_t start = test_nanos();
+    for (int i = 0; i < FRAMES; i++) {
+        sink = f();
+    }
+    return (double) (test_nanos() - start) / FRAMES;
+}
+
+// 主机有硬件浮点, ESP8266 上软浮点的差距会大得多, 这里只比较相对开销
+TEST(waveform_level_per_frame) {
+    OldBreath oldBreath;
+    OldBlink oldBlink;
+    Waveform breath(WAVE_PARABOLA, 1000000, 500000);
+    Waveform blink(WAVE_SQUARE, 1000000, 1000000);
+    Waveform sine(WAVE_SINE, 1000000, 500000);
+    Waveform ease(WAVE_EASE, 1000000, 500000);
+    test_report("breath, double parabola", time_frames([&]() { return oldBreath.update(); }), "ns/frame");
+    test_report("breath, Waveform parabola", time_frames([&]() { return breath.advance(16666); }), "ns/frame");
+    test_report("blink, float thresholds", time_frames([&]() { return oldBlink.update(); }), "ns/frame");
+    test_report("blink, Waveform square", time_frames([&]() { return blink.advance(16666); }), "ns/frame");
+    test_report("Waveform sine", time_frames([&]() { return sine.advance(16666); }), "ns/frame");
+    test_report("Waveform ease", time_frames([&]() { return ease.advance(16666); }), "ns/frame");
+}
@@ -0,0 +1,65 @@
+#!/usr/bin/env python3
+# coding=utf-8
+
+# 生成测试和基准用的动画, 二进制动画由 pack_anim.py 编码
+
+import os
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+from pack_anim import encode, parse_csv
+
+PANEL_SIZE = 16
+PANEL_FRAMES = 1000
+
+def hue(h):
+    """色相 0-63 对应的颜色"""
+    h = h % 64 * 4
+    if h < 86:
+        return bytes([255 - h * 3, h * 3, 0])
+    if h < 171:
+        return bytes([0, 255 - (h - 86) * 3, (h - 86) * 3])
+    return bytes([(h - 171) * 3, 0, 255 - (h - 171) * 3])
+
+def panel_frames():
+    """16x16 灯板的合成画面: 深色背景上移动的彩色竖条"""
+    background = bytes([0, 0, 32])
+    frames = []
+    for f in range(PANEL_FRAMES):
+        frame = []
+        for y in range(PANEL_SIZE):
+            for x in range(PANEL_SIZE):
+                frame.append(hue(y * 4 + f) if (x + f // 4) % PANEL_SIZE < 3 else background)
+        frames.append(frame)
+    return frames
+
+def write_csv(path, frames):
+    with open(path, "w", encoding="utf-8") as file:
+        for frame in frames:
+            file.write(",".join("#" + pixel.hex().upper() for pixel in frame) + "\n")
+
+def write_anim(path, frames, **options):
+    with open(path, "wb") as file:
+        file.write(encode(frames, len(frames[0]), 0, **options))
+
+if __name__ == "__main__":
+    out = sys.argv[1] if len(sys.argv) > 1 else "build/fsroot/animations"
+    os.makedirs(out, exist_ok=True)
+    root = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+    sources = {
+        "panel": panel_frames(),
+        "example": parse_csv(os.path.join(root, "data", "animations", "example.csv")),
+    }
+    for name, frames in sources.items():
+        write_csv(os.path.join(out, name + ".csv"), frames)
+        write_anim(os.path.join(out, name + ".anim"), frames,
+                   compress=False, palette_mode=False, keyframe_interval=0)
+        # 压缩格式: 行程编码, 调色板, 每帧都是关键帧, 以及没有关键帧索引
+        write_anim(os.path.join(out, name + "_rle.anim"), frames,
+                   compress=True, palette_mode=False, keyframe_interval=30)
+        write_anim(os.path.join(out, name + "_palette.anim"), frames,
+                   compress=True, palette_mode=True, keyframe_interval=30)
+        write_anim(os.path.join(out, name + "_intra.anim"), frames,
+                   compress=True, palette_mode=False, keyframe_interval=1)
+        write_anim(os.path.join(out, name + "_noindex.anim"), frames,
+                   compress=True, palette_mode=True, keyframe_interval=0)
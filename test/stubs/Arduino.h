@@ -0,0 +1,105 @@
+// Arduino core 的最小替身, 仅供在主机上编译测试
+
+#ifndef __STUB_ARDUINO_H__
+#define __STUB_ARDUINO_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <ctype.h>
+#include <time.h>
+#include <algorithm>
+#include <string>
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define F(s) (s)
+#define FPSTR(s) (s)
+#define ICACHE_RAM_ATTR
+#define IRAM_ATTR
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+typedef char __FlashStringHelper;
+
+inline uint8_t pgm_read_byte(const void *p) { return *(const uint8_t *) p; }
+inline uint16_t pgm_read_word(const void *p) { return *(const uint16_t *) p; }
+inline uint32_t pgm_read_dword(const void *p) { return *(const uint32_t *) p; }
+inline const void *pgm_read_ptr(const void *p) { return *(const void *const *) p; }
+
+#define memcpy_P memcpy
+#define strcmp_P strcmp
+#define strncmp_P strncmp
+#define strlen_P strlen
+#define strcpy_P strcpy
+#define sprintf_P sprintf
+#define snprintf_P snprintf
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void yield();
+
+class String {
+private:
+    std::string s;
+
+public:
+    String() {}
+    String(const char *str) : s(str ? str : "") {}
+    String(const std::string &str) : s(str) {}
+
+    const char *c_str() const { return s.c_str(); }
+    unsigned length() const { return s.size(); }
+    bool isEmpty() const { return s.empty(); }
+    bool startsWith(const char *prefix) const { return s.compare(0, strlen(prefix), prefix) == 0; }
+    bool endsWith(const char *suffix) const {
+        size_t n = strlen(suffix);
+        return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+    }
+    long toInt() const { return atol(s.c_str()); }
+    String substring(unsigned from, unsigned to) const { return String(s.substr(from, to - from)); }
+
+    String &operator=(const char *str) { s = str ? str : ""; return *this; }
+    String &operator+=(const String &other) { s += other.s; return *this; }
+    bool operator==(const char *str) const { return s == str; }
+    bool operator!=(const char *str) const { return s != str; }
+    friend String operator+(const String &a, const String &b) { return String(a.s + b.s); }
+};
+
+// 串口输出在测试中丢弃
+class Print {
+public:
+    template <typename T> size_t print(const T &) { return 0; }
+    template <typename T> size_t println(const T &) { return 0; }
+    size_t println() { return 0; }
+    size_t printf(const char *, ...) { return 0; }
+    size_t printf_P(const char *, ...) { return 0; }
+};
+
+class Stream : public Print {
+public:
+    virtual ~Stream() {}
+    virtual int available() { return 0; }
+    virtual int read() { return -1; }
+    virtual size_t write(uint8_t) { return 1; }
+    virtual size_t write(const uint8_t *, size_t n) { return n; }
+};
+
+extern Stream Serial;
+
+class EspClass {
+public:
+    uint32_t maxFreeBlockSize = 20000; // 测试可修改, 用于模拟内存不足
+
+    uint32_t getCycleCount();
+    uint32_t getMaxFreeBlockSize() { return maxFreeBlockSize; }
+    uint32_t getFreeHeap() { return maxFreeBlockSize; }
+};
+
+extern EspClass ESP;
+
+#endif // __STUB_ARDUINO_H__
@@ -0,0 +1,181 @@
+// ArduinoJson 的最小替身, 支持灯效和布局读写 JSON 用到的部分, 不支持序列化
+
+#ifndef __STUB_ARDUINOJSON_H__
+#define __STUB_ARDUINOJSON_H__
+
+#include <Arduino.h>
+#include <list>
+#include <map>
+#include <string>
+#include <type_traits>
+
+struct JsonNode {
+    enum Kind { NUL, NUMBER, STRING, ARRAY, OBJECT };
+
+    Kind kind = NUL;
+    double number = 0;
+    std::string str;
+    std::list<JsonNode> array;
+    std::map<std::string, JsonNode> object;
+};
+
+class JsonArray;
+class JsonObject;
+
+class JsonVariant {
+protected:
+    JsonNode *node;
+
+    template <typename T>
+    using Scalar = typename std::enable_if<std::is_arithmetic<T>::value || std::is_enum<T>::value>::type;
+
+public:
+    JsonVariant(JsonNode *node = nullptr) : node(node) {}
+
+    template <typename T, typename = Scalar<T>>
+    JsonVariant &operator=(T value) {
+        node->kind = JsonNode::NUMBER;
+        node->number = (double) value;
+        return *this;
+    }
+
+    JsonVariant &operator=(const char *value) {
+        node->kind = JsonNode::STRING;
+        node->str = value ? value : "";
+        return *this;
+    }
+
+    JsonVariant &operator=(const String &value) {
+        return *this = value.c_str();
+    }
+
+    bool isNull() const {
+        return !node || node->kind == JsonNode::NUL;
+    }
+
+    template <typename T, typename = Scalar<T>>
+    T as() const {
+        return node && node->kind == JsonNode::NUMBER ? (T) node->number : T();
+    }
+
+    template <typename T, typename = Scalar<T>>
+    operator T() const {
+        return as<T>();
+    }
+
+    operator const char *() const {
+        return node && node->kind == JsonNode::STRING ? node->str.c_str() : nullptr;
+    }
+
+    template <typename T, typename = Scalar<T>>
+    T operator|(T fallback) const {
+        return node && node->kind == JsonNode::NUMBER ? (T) node->number : fallback;
+    }
+
+    const char *operator|(const char *fallback) const {
+        return node && node->kind == JsonNode::STRING ? node->str.c_str() : fallback;
+    }
+
+    JsonVariant operator[](const char *key) const {
+        if (node->kind != JsonNode::OBJECT) {
+            node->kind = JsonNode::OBJECT;
+        }
+        return JsonVariant(&node->object[key]);
+    }
+
+    JsonVariant operator[](int index) const {
+        auto it = node->array.begin();
+        std::advance(it, index);
+        return JsonVariant(&*it);
+    }
+
+    size_t size() const {
+        return node ? (node->kind == JsonNode::ARRAY ? node->array.size() : node->object.size()) : 0;
+    }
+
+    bool containsKey(const char *key) const {
+        auto it = node->object.find(key);
+        return it != node->object.end() && it->second.kind != JsonNode::NUL;
+    }
+
+    JsonObject createNestedObject(const char *key = nullptr);
+    JsonArray createNestedArray(const char *key = nullptr);
+
+    friend class JsonArray;
+};
+
+class JsonObject : public JsonVariant {
+public:
+    JsonObject(JsonNode *node = nullptr) : JsonVariant(node) {}
+};
+
+class JsonArray : public JsonVariant {
+public:
+    class iterator {
+    private:
+        std::list<JsonNode>::iterator it;
+
+    public:
+        iterator(std::list<JsonNode>::iterator it) : it(it) {}
+        JsonVariant operator*() const { return JsonVariant(&*it); }
+        iterator &operator++() { ++it; return *this; }
+        bool operator!=(const iterator &other) const { return it != other.it; }
+    };
+
+    JsonArray(JsonNode *node = nullptr) : JsonVariant(node) {}
+    JsonArray(const JsonVariant &variant) : JsonVariant(variant) {}
+
+    template <typename T>
+    bool add(T value) {
+        node->array.emplace_back();
+        JsonVariant(&node->array.back()) = value;
+        return true;
+    }
+
+    iterator begin() const { return iterator(node->array.begin()); }
+    iterator end() const { return iterator(node->array.end()); }
+};
+
+inline JsonObject JsonVariant::createNestedObject(const char *key) {
+    JsonNode *child = key ? &(*this)[key].node[0] : (node->array.emplace_back(), &node->array.back());
+    child->kind = JsonNode::OBJECT;
+    return JsonObject(child);
+}
+
+inline JsonArray JsonVariant::createNestedArray(const char *key) {
+    JsonNode *child = key ? &(*this)[key].node[0] : (node->array.emplace_back(), &node->array.back());
+    child->kind = JsonNode::ARRAY;
+    return JsonArray(child);
+}
+
+class JsonDocument : public JsonObject {
+private:
+    JsonNode root;
+
+public:
+    JsonDocument() : JsonObject(&root) {
+        root.kind = JsonNode::OBJECT;
+    }
+
+    JsonDocument(const JsonDocument &) = delete;
+
+    void clear() {
+        root = JsonNode();
+        root.kind = JsonNode::OBJECT;
+    }
+};
+
+template <size_t N>
+class StaticJsonDocument : public JsonDocument {};
+
+struct DeserializationError {
+    operator bool() const { return true; }
+    const char *c_str() const { return "Not supported"; }
+};
+
+template <typename Source>
+DeserializationError deserializeJson(JsonDocument &, Source &) {
+    return DeserializationError();
+}
+
+#endif // __STUB_ARDUINOJSON_H__
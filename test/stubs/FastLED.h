@@ -0,0 +1,137 @@
+// FastLED 的最小替身, 颜色运算与 FastLED 相同, 输出为空操作
+
+#ifndef __STUB_FASTLED_H__
+#define __STUB_FASTLED_H__
+
+#include <Arduino.h>
+
+typedef uint8_t fract8;
+
+inline uint8_t scale8(uint8_t i, fract8 scale) {
+    return ((uint16_t) i * (1 + scale)) >> 8;
+}
+
+inline uint8_t scale8_video(uint8_t i, fract8 scale) {
+    return (((int) i * (int) scale) >> 8) + ((i && scale) ? 1 : 0);
+}
+
+inline uint8_t qadd8(uint8_t i, uint8_t j) {
+    int t = i + j;
+    return t > 255 ? 255 : t;
+}
+
+// 与 FastLED 的 sin8_C 相同, 按 4 段折线近似
+inline uint8_t sin8(uint8_t theta) {
+    static const uint8_t b_m16_interleave[] = {0, 49, 49, 41, 90, 27, 117, 10};
+    uint8_t offset = theta;
+    if (theta & 0x40) {
+        offset = (uint8_t) 255 - offset;
+    }
+    offset &= 0x3F;
+    uint8_t secoffset = offset & 0x0F;
+    if (theta & 0x40) {
+        secoffset++;
+    }
+    const uint8_t *p = b_m16_interleave + (offset >> 4) * 2;
+    uint8_t mx = (p[1] * secoffset) >> 4;
+    int8_t y = mx + p[0];
+    if (theta & 0x80) {
+        y = -y;
+    }
+    return y + 128;
+}
+
+inline uint8_t cos8(uint8_t theta) {
+    return sin8(theta + 64);
+}
+
+inline uint8_t ease8InOutQuad(uint8_t i) {
+    uint8_t j = i & 0x80 ? 255 - i : i;
+    uint8_t jj = scale8(j, j);
+    uint8_t jj2 = jj << 1;
+    return i & 0x80 ? 255 - jj2 : jj2;
+}
+
+struct CHSV {
+    uint8_t h, s, v;
+
+    CHSV() {}
+    CHSV(uint8_t h, uint8_t s, uint8_t v) : h(h), s(s), v(v) {}
+};
+
+struct CRGB {
+    union {
+        struct {
+            uint8_t r, g, b;
+        };
+        uint8_t raw[3];
+    };
+
+    enum HTMLColorCode {
+        Black = 0x000000,
+        Red = 0xFF0000,
+        Green = 0x008000,
+        Blue = 0x0000FF,
+        White = 0xFFFFFF,
+    };
+
+    CRGB() {}
+    CRGB(uint8_t r, uint8_t g, uint8_t b) : r(r), g(g), b(b) {}
+    CRGB(uint32_t color) : r(color >> 16), g(color >> 8), b(color) {}
+    CRGB(HTMLColorCode color) : CRGB((uint32_t) color) {}
+    CRGB(const CHSV &hsv);
+
+    CRGB &operator=(uint32_t color) {
+        r = color >> 16;
+        g = color >> 8;
+        b = color;
+        return *this;
+    }
+
+    CRGB &nscale8(uint8_t scale) {
+        r = scale8(r, scale);
+        g = scale8(g, scale);
+        b = scale8(b, scale);
+        return *this;
+    }
+
+    uint8_t &operator[](int i) { return raw[i]; }
+    bool operator==(const CRGB &o) const { return r == o.r && g == o.g && b == o.b; }
+    bool operator!=(const CRGB &o) const { return !(*this == o); }
+};
+
+// 色相按 3 段线性插值, 与 FastLED 的彩虹色表不同但同样连续
+inline void hsv2rgb_rainbow(const CHSV &hsv, CRGB &rgb) {
+    uint8_t offset = (hsv.h % 86) * 3;
+    uint8_t rise = offset, fall = 255 - offset;
+    CRGB c = hsv.h < 86 ? CRGB(fall, rise, 0) : hsv.h < 172 ? CRGB(0, fall, rise) : CRGB(rise, 0, fall);
+    uint8_t white = 255 - hsv.s;
+    c.r = scale8(qadd8(c.r, white), hsv.v);
+    c.g = scale8(qadd8(c.g, white), hsv.v);
+    c.b = scale8(qadd8(c.b, white), hsv.v);
+    rgb = c;
+}
+
+inline CRGB::CRGB(const CHSV &hsv) {
+    hsv2rgb_rainbow(hsv, *this);
+}
+
+inline void fill_solid(CRGB *leds, int count, const CRGB &color) {
+    for (int i = 0; i < count; i++) {
+        leds[i] = color;
+    }
+}
+
+inline void fill_rainbow(CRGB *leds, int count, uint8_t initialHue, uint8_t deltaHue = 5) {
+    for (int i = 0; i < count; i++) {
+        hsv2rgb_rainbow(CHSV(initialHue + i * deltaHue, 240, 255), leds[i]);
+    }
+}
+
+inline void nscale8(CRGB *leds, uint16_t count, uint8_t scale) {
+    for (int i = 0; i < count; i++) {
+        leds[i].nscale8(scale);
+    }
+}
+
+#endif // __STUB_FASTLED_H__
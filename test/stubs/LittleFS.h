@@ -0,0 +1,93 @@
+// LittleFS 的最小替身, 文件放在当前目录的 fsroot 下
+
+#ifndef __STUB_LITTLEFS_H__
+#define __STUB_LITTLEFS_H__
+
+#include <Arduino.h>
+#include <memory>
+#include <string>
+
+enum SeekMode { SeekSet, SeekCur, SeekEnd };
+
+class File : public Stream {
+private:
+    std::shared_ptr<FILE> fp;
+
+    static int openCount;
+
+public:
+    File() {}
+
+    explicit File(FILE *f) : fp(f, [](FILE *f) {
+        fclose(f);
+        openCount--;
+    }) {
+        openCount++;
+    }
+
+    /**
+     * @brief Number of files currently open, for leak checks
+     */
+    static int opened() {
+        return openCount;
+    }
+
+    size_t write(uint8_t c) override { return fwrite(&c, 1, 1, fp.get()); }
+    size_t write(const uint8_t *buf, size_t n) override { return fwrite(buf, 1, n, fp.get()); }
+    int read() override { return fgetc(fp.get()); }
+    size_t read(uint8_t *buf, size_t n) { return fread(buf, 1, n, fp.get()); }
+    int available() override { return size() - position(); }
+
+    bool seek(uint32_t pos, SeekMode mode = SeekSet) {
+        return fseek(fp.get(), pos, mode == SeekSet ? SEEK_SET : mode == SeekCur ? SEEK_CUR : SEEK_END) == 0;
+    }
+
+    size_t position() const { return ftell(fp.get()); }
+
+    size_t size() const {
+        long pos = ftell(fp.get());
+        fseek(fp.get(), 0, SEEK_END);
+        long end = ftell(fp.get());
+        fseek(fp.get(), pos, SEEK_SET);
+        return end;
+    }
+
+    void close() { fp.reset(); }
+    void flush() { fflush(fp.get()); }
+    bool isFile() const { return (bool) fp; }
+    operator bool() const { return (bool) fp; }
+};
+
+class FS {
+private:
+    static std::string path(const char *p) {
+        return std::string("fsroot") + p;
+    }
+
+public:
+    bool begin() { return true; }
+
+    File open(const String &p, const char *mode) { return open(p.c_str(), mode); }
+
+    File open(const char *p, const char *mode) {
+        FILE *f = fopen(path(p).c_str(), (std::string(mode) + "b").c_str());
+        return f ? File(f) : File();
+    }
+
+    bool exists(const String &p) { return exists(p.c_str()); }
+
+    bool exists(const char *p) {
+        FILE *f = fopen(path(p).c_str(), "rb");
+        if (f) {
+            fclose(f);
+        }
+        return f;
+    }
+
+    bool remove(const String &p) { return remove(p.c_str()); }
+    bool remove(const char *p) { return ::remove(path(p).c_str()) == 0; }
+};
+
+extern FS LittleFS;
+
+#endif // __STUB_LITTLEFS_H__
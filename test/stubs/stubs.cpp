@@ -0,0 +1,27 @@
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <chrono>
+
+Stream Serial;
+EspClass ESP;
+FS LittleFS;
+
+int File::openCount = 0;
+
+static const auto start = std::chrono::steady_clock::now();
+
+unsigned long micros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+unsigned long millis() {
+    return micros() / 1000;
+}
+
+void delay(unsigned long) {}
+
+void yield() {}
+
+uint32_t EspClass::getCycleCount() {
+    return micros() * 80;
+}
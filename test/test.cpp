@@ -0,0 +1,101 @@
+#include "test.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+TestCase *TestCase::first = nullptr;
+
+static uint64_t allocations = 0;
+static uint64_t deallocations = 0;
+static int failures = 0;
+static bool failed = false;
+
+void *operator new(size_t size) {
+    allocations++;
+    void *p = malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+    allocations++;
+    return malloc(size ? size : 1);
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &tag) noexcept {
+    return operator new(size, tag);
+}
+
+void operator delete(void *p) noexcept {
+    deallocations += p != nullptr;
+    free(p);
+}
+
+void operator delete[](void *p) noexcept {
+    operator delete(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+    operator delete(p);
+}
+
+void operator delete[](void *p, size_t) noexcept {
+    operator delete(p);
+}
+
+void test_fail(const char *file, int line, const char *expr, const long long *a, const long long *b) {
+    if (a && b) {
+        printf("  %s:%d: CHECK(%s) failed: %lld != %lld\n", file, line, expr, *a, *b);
+    } else {
+        printf("  %s:%d: CHECK(%s) failed\n", file, line, expr);
+    }
+    failed = true;
+}
+
+uint64_t test_allocations() {
+    return allocations;
+}
+
+uint64_t test_live_allocations() {
+    return allocations - deallocations;
+}
+
+uint64_t test_nanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void test_report(const char *name, double value, const char *unit) {
+    printf("  %-40s %12.2f %s\n", name, value, unit);
+}
+
+int main(int argc, char **argv) {
+    // 注册顺序与文件内顺序相反, 先反转链表
+    TestCase *ordered = nullptr;
+    while (TestCase::first) {
+        TestCase *test = TestCase::first;
+        TestCase::first = test->next;
+        test->next = ordered;
+        ordered = test;
+    }
+    int count = 0;
+    for (TestCase *test = ordered; test; test = test->next) {
+        if (argc > 1 && !strstr(test->name, argv[1])) {
+            continue;
+        }
+        printf("%s\n", test->name);
+        failed = false;
+        test->run();
+        failures += failed;
+        count++;
+    }
+    printf("%d run, %d failed\n", count, failures);
+    return failures ? 1 : 0;
+}
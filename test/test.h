@@ -0,0 +1,65 @@
+// 主机测试框架: TEST 注册用例, CHECK 失败时打印位置并结束当前用例
+
+#ifndef __TEST_H__
+#define __TEST_H__
+
+#include <stdint.h>
+#include <stdio.h>
+
+struct TestCase {
+    const char *name;
+    void (*run)();
+    TestCase *next;
+
+    static TestCase *first;
+
+    TestCase(const char *name, void (*run)()) : name(name), run(run), next(first) {
+        first = this;
+    }
+};
+
+#define TEST(name)                                          \
+    static void test_##name();                              \
+    static TestCase test_case_##name(#name, test_##name);   \
+    static void test_##name()
+
+#define CHECK(cond)                                         \
+    do {                                                    \
+        if (!(cond)) {                                      \
+            test_fail(__FILE__, __LINE__, #cond, 0, 0);     \
+            return;                                         \
+        }                                                   \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                          \
+    do {                                                                        \
+        long long test_a = (long long) (a), test_b = (long long) (b);           \
+        if (test_a != test_b) {                                                 \
+            test_fail(__FILE__, __LINE__, #a " == " #b, &test_a, &test_b);      \
+            return;                                                             \
+        }                                                                       \
+    } while (0)
+
+void test_fail(const char *file, int line, const char *expr, const long long *a, const long long *b);
+
+/**
+ * @brief Number of operator new calls since the program started
+ */
+uint64_t test_allocations();
+
+/**
+ * @brief Number of blocks allocated and not yet freed
+ */
+uint64_t test_live_allocations();
+
+/**
+ * @brief Monotonic time in nanoseconds, for benchmarks
+ */
+uint64_t test_nanos();
+
+/**
+ * @brief Print one benchmark result line
+ */
+void test_report(const char *name, double value, const char *unit);
+
+#endif // __TEST_H__
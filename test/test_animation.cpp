@@ -0,0 +1,58 @@
+#include "test.h"
+
+#include "LightEffect.hpp"
+
+// 动画由 make_fixtures.py 生成, 二进制动画与同名 CSV 内容相同
+typedef LightStrip<256, false> Strip;
+
+template <typename Light>
+static bool same_frames(const char *csv, const char *anim, int frames) {
+    static Light a, b;
+    AnimationEffect text(csv), binary(anim);
+    for (int i = 0; i < frames; i++) {
+        if (!text.update(a, 16666) || !binary.update(b, 16666) ||
+            memcmp(a.data(), b.data(), sizeof(CRGB) * a.count()) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST(animation_binary_matches_csv) {
+    CHECK(same_frames<Strip>("panel.csv", "panel.anim", 1000));
+    CHECK(same_frames<Strip>("example.csv", "example.anim", 31));
+}
+
+// 灯珠数与动画不同时, 多余的像素跳过, 多余的灯珠不变
+TEST(animation_binary_other_led_count) {
+    CHECK((same_frames<LightStrip<100, false>>("panel.csv", "panel.anim", 50)));
+    CHECK((same_frames<LightStrip<30, false>>("example.csv", "example.anim", 31)));
+}
+
+// 播完后从首帧继续, 不插入重复的帧
+TEST(animation_binary_loops) {
+    static Strip first, light;
+    AnimationEffect binary("panel.anim");
+    CHECK(binary.update(first, 16666));
+    for (int i = 1; i < 1000; i++) {
+        CHECK(binary.update(light, 16666));
+    }
+    CHECK(binary.update(light, 16666));
+    CHECK(memcmp(first.data(), light.data(), sizeof(first)) == 0);
+}
+
+TEST(animation_header_detects_format) {
+    AnimHeader header;
+    File csv = LittleFS.open("/animations/panel.csv", "r");
+    CHECK(!read_anim_header(csv, header));
+    CHECK_EQ(csv.position(), 0);
+    csv.close();
+
+    File anim = LittleFS.open("/animations/panel.anim", "r");
+    CHECK(read_anim_header(anim, header));
+    CHECK_EQ(header.format, ANIM_RGB);
+    CHECK_EQ(header.ledCount, 256);
+    CHECK_EQ(header.frameCount, 1000);
+    CHECK_EQ(anim.size(), header.frameOffset(header.frameCount));
+    anim.close();
+}
@@ -0,0 +1,103 @@
+#include "test.h"
+
+#include "LightCompositor.hpp"
+
+// 打包内核与逐通道的 channel_blend 结果必须逐字节相同
+TEST(blend_kernels_match_channel_reference) {
+    const int MAX_COUNT = 13; // 含奇数个灯珠, 覆盖按字节处理的尾部
+    alignas(4) CRGB dst[MAX_COUNT], src[MAX_COUNT], base[MAX_COUNT];
+    srand(1);
+    for (int round = 0; round < 200; round++) {
+        for (int i = 0; i < MAX_COUNT; i++) {
+            for (int c = 0; c < 3; c++) {
+                int r = rand() % 8;
+                base[i].raw[c] = r == 0 ? 0 : r == 1 ? 255 : rand() % 256;
+                r = rand() % 8;
+                src[i].raw[c] = r == 0 ? 0 : r == 1 ? 255 : rand() % 256;
+            }
+        }
+        for (int mode = 0; mode < BLEND_MODE_COUNT; mode++) {
+            for (int opacity = 0; opacity < 256; opacity += round % 2 ? 1 : 51) {
+                int count = 1 + (round + opacity) % MAX_COUNT;
+                memcpy(dst, base, sizeof(base));
+                blend_frame(dst, src, count, (BlendMode) mode, opacity);
+                for (int i = 0; i < count; i++) {
+                    for (int c = 0; c < 3; c++) {
+                        uint8_t expected = channel_blend(base[i].raw[c], src[i].raw[c], (BlendMode) mode, opacity + 1);
+                        CHECK_EQ(dst[i].raw[c], expected);
+                    }
+                }
+                for (int i = count; i < MAX_COUNT; i++) {
+                    CHECK(dst[i] == base[i]); // 不能越界写入
+                }
+            }
+        }
+    }
+}
+
+TEST(lerp_frame_matches_channel_reference) {
+    const int COUNT = 11;
+    alignas(4) CRGB a[COUNT], b[COUNT], out[COUNT];
+    for (int i = 0; i < COUNT; i++) {
+        a[i] = CRGB(i * 23, 255 - i * 7, i * 91);
+        b[i] = CRGB(255 - i * 13, i * 3, 128 + i);
+    }
+    for (int alpha = 0; alpha <= 256; alpha++) {
+        lerp_frame(out, a, b, COUNT, alpha);
+        for (int i = 0; i < COUNT; i++) {
+            for (int c = 0; c < 3; c++) {
+                CHECK_EQ(out[i].raw[c], (a[i].raw[c] * (256 - alpha) >> 8) + (b[i].raw[c] * alpha >> 8));
+            }
+        }
+    }
+}
+
+typedef LightStrip<30, false> Strip;
+
+TEST(compositor_blends_layers_over_base) {
+    Strip out;
+    Compositor<Strip, 2> compositor;
+    fill_solid(out.data(), out.count(), CRGB(0x102030));
+    compositor.set(out, 0, ConstantEffect(0x010101), BLEND_ADD, 255);
+    CHECK(compositor.active());
+    CHECK(compositor.compose(out, false, 16666));
+    CHECK(out.data()[0] == CRGB(0x112131));
+    CHECK(!compositor.compose(out, false, 16666));
+}
+
+// 移除图层后下一帧必须重新输出, 即使底层灯效是静止的
+TEST(compositor_clear_reports_change) {
+    Strip out;
+    Compositor<Strip, 2> compositor;
+    fill_solid(out.data(), out.count(), CRGB(0x102030));
+    compositor.set(out, 0, ConstantEffect(0x010101), BLEND_ADD, 255);
+    compositor.set(out, 1, ConstantEffect(0x020202), BLEND_ADD, 255);
+    compositor.compose(out, false, 16666);
+    CHECK(out.data()[0] == CRGB(0x132333));
+
+    CHECK(compositor.clear(out, 1));
+    CHECK(!compositor.clear(out, 1));
+    CHECK(compositor.compose(out, false, 16666));
+    CHECK(out.data()[0] == CRGB(0x112131));
+
+    CHECK(compositor.clear(out, 0));
+    CHECK(!compositor.active());
+    CHECK(compositor.compose(out, false, 16666));
+    CHECK(out.data()[0] == CRGB(0x102030));
+    CHECK(!compositor.compose(out, false, 16666));
+}
+
+// 没有图层时不占用帧内存, 内存不足时设置失败且不改变状态
+TEST(compositor_allocates_frames_on_demand) {
+    Strip out;
+    Compositor<Strip, 2> compositor;
+    typedef LightPanel<16, 16, Z_WORD | HORIZONTAL> Panel;
+    CHECK(sizeof(Compositor<Panel, 2>) < sizeof(Panel));
+    uint64_t live = test_live_allocations();
+    CHECK(compositor.set(out, 0, ConstantEffect(0x010101), BLEND_ADD, 255));
+    CHECK_EQ(test_live_allocations() - live, 2);
+    CHECK(&compositor.target(out) != &out);
+    CHECK(compositor.clear(out, 0));
+    CHECK_EQ(test_live_allocations(), live);
+    CHECK(&compositor.target(out) == &out);
+}
@@ -0,0 +1,191 @@
+#include "test.h"
+
+#include "CubeRenderer.hpp"
+#include "LightCompositor.hpp"
+
+typedef LightCube<8, 8, 8> Cube;
+
+// 与 Rgb565 精度相同的颜色, 编解码后不变
+static const CRGB RED(0xFF, 0x00, 0x00);
+
+static int lit(Cube &cube) {
+    int n = 0;
+    for (int i = 0; i < Cube::count(); i++) {
+        n += cube.data()[i] != CRGB(0, 0, 0);
+    }
+    return n;
+}
+
+TEST(rgb565_round_trip_keeps_high_bits) {
+    Rgb565 format;
+    for (int c = 0; c < 256; c += 5) {
+        CRGB decoded = format.decode(format.encode(CRGB(c, c, c)));
+        CHECK_EQ(decoded.r & 0xF8, c & 0xF8);
+        CHECK_EQ(decoded.g & 0xFC, c & 0xFC);
+        CHECK_EQ(decoded.b & 0xF8, c & 0xF8);
+    }
+    CHECK(format.decode(format.encode(CRGB(255, 255, 255))) == CRGB(255, 255, 255));
+}
+
+TEST(fill_plane_covers_one_layer) {
+    const CubeAxis axes[] = {AXIS_X, AXIS_Y, AXIS_Z};
+    for (CubeAxis axis : axes) {
+        static Cube cube;
+        fill_solid(cube.data(), Cube::count(), CRGB(0, 0, 0));
+        fillPlane(cube, axis, 3, RED);
+        CHECK_EQ(lit(cube), 64);
+        CHECK(cube.at(axis == AXIS_X ? 3 : 7, axis == AXIS_Y ? 3 : 7, axis == AXIS_Z ? 3 : 7) == RED);
+    }
+}
+
+TEST(draw_line_hits_both_ends) {
+    static Cube cube;
+    fill_solid(cube.data(), Cube::count(), CRGB(0, 0, 0));
+    drawLine(cube, 0, 0, 0, 7, 7, 7, RED);
+    CHECK_EQ(lit(cube), 8);
+    for (int i = 0; i < 8; i++) {
+        CHECK(cube.at(i, i, i) == RED);
+    }
+
+    fill_solid(cube.data(), Cube::count(), CRGB(0, 0, 0));
+    drawLine(cube, 7, 0, 2, 0, 3, 5, RED);
+    CHECK(cube.at(7, 0, 2) == RED);
+    CHECK(cube.at(0, 3, 5) == RED);
+    CHECK_EQ(lit(cube), 8);
+}
+
+TEST(draw_sprite_clips_to_cube) {
+    static const uint8_t bits[] PROGMEM = {0xFF}; // 2x2x2 全部点亮
+    VoxelSprite sprite = {2, 2, 2, bits};
+    static Cube cube;
+    fill_solid(cube.data(), Cube::count(), CRGB(0, 0, 0));
+    drawSprite(cube, sprite, -1, 7, 3, RED);
+    CHECK_EQ(lit(cube), 2);
+    CHECK(cube.at(0, 7, 3) == RED);
+    CHECK(cube.at(0, 7, 4) == RED);
+}
+
+TEST(packed_cube_expands_like_light_cube) {
+    static Cube direct;
+    static Cube expanded;
+    static PackedCube<8, 8, 8, Rgb565> rgb;
+    static PackedCube<8, 8, 8, Palette8> palette;
+    palette.format.palette[0] = CRGB(0, 0, 0);
+    palette.format.palette[1] = RED;
+
+    fill_solid(direct.data(), Cube::count(), CRGB(0, 0, 0));
+    fillPlane(direct, AXIS_Y, 2, RED);
+    drawLine(direct, 0, 7, 0, 7, 0, 7, RED);
+    fillPlane(rgb, AXIS_Y, 2, RED);
+    drawLine(rgb, 0, 7, 0, 7, 0, 7, RED);
+    fillPlane(palette, AXIS_Y, 2, 1);
+    drawLine(palette, 0, 7, 0, 7, 0, 7, 1);
+
+    rgb.expand(expanded.data());
+    CHECK(memcmp(direct.data(), expanded.data(), sizeof(CRGB) * Cube::count()) == 0);
+    palette.expand(expanded.data());
+    CHECK(memcmp(direct.data(), expanded.data(), sizeof(CRGB) * Cube::count()) == 0);
+}
+
+typedef PackedCube<8, 8, 8, Rgb565> Packed;
+
+// 压缩帧与 CRGB 帧经 RGB565 编解码后逐灯珠相同
+static bool same_as_rgb565(const CRGB *packed, const CRGB *direct, int count) {
+    Rgb565 format;
+    for (int i = 0; i < count; i++) {
+        if (packed[i] != format.decode(format.encode(direct[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST(packed_cube_shrinks_render_buffers) {
+    // 输出缓冲仍为 CRGB, 渲染缓冲和图层/过渡的帧按压缩格式分配
+    CHECK_EQ(sizeof(DoubleBuffer<LightCube<16, 16, 16>>), 4096 * 6);
+    CHECK_EQ(sizeof(DoubleBuffer<PackedCube<16, 16, 16, Rgb565>>), 4096 * 5);
+    CHECK_EQ(sizeof(DoubleBuffer<PackedCube<16, 16, 16, Palette8>>), 4096 * 4);
+    CHECK_EQ(sizeof(PackedCube<16, 16, 16, Rgb565>), 4096 * 2);
+    CHECK_EQ(sizeof(PackedCube<16, 16, 16, Palette8>), 4096);
+}
+
+TEST(packed_cube_renders_effects_like_light_cube) {
+    const EffectType types[] = {CONSTANT, BLINK, BREATH, CHASE, RAINBOW, STREAM};
+    static const char *args[][3] = {
+        {"#FF0000"}, {"#00FF00", "0.5", "0.5"}, {"#0000FF", "1", "0.5"},
+        {"#FFFFFF", "1", "0.1"}, {"5"}, {"1", "3"},
+    };
+    static DoubleBuffer<Cube> direct;
+    static DoubleBuffer<Packed> packed;
+    for (int t = 0; t < (int) ARRAY_LENGTH(types); t++) {
+        Effect<Cube> a = Effect<Cube>::create(types[t], 3, args[t]);
+        Effect<Packed> b = Effect<Packed>::create(types[t], 3, args[t]);
+        for (int frame = 0; frame < 20; frame++) {
+            a.update(direct, 33333);
+            b.update(packed, 33333);
+            direct.swap();
+            packed.swap();
+            CHECK(same_as_rgb565(packed.front(), direct.front(), Cube::count()));
+        }
+    }
+}
+
+TEST(packed_cube_composites_and_transitions) {
+    static Cube direct;
+    static Packed packed;
+    Compositor<Cube, 1> compositor;
+    Compositor<Packed, 1> packedCompositor;
+    fill_solid(direct.data(), direct.count(), CRGB(0x102030));
+    fill_solid(packed.data(), packed.count(), CRGB(0x102030));
+    compositor.set(direct, 0, ConstantEffect(0x405060), BLEND_ADD, 128);
+    packedCompositor.set(packed, 0, ConstantEffect(0x405060), BLEND_ADD, 128);
+    compositor.compose(direct, false, 16666);
+    packedCompositor.compose(packed, false, 16666);
+    static CRGB expanded[Packed::count()];
+    packed.expand(expanded);
+    CHECK(same_as_rgb565(expanded, direct.data(), Cube::count()));
+
+    // 两端颜色在 RGB565 中无损, 过渡中间帧与 CRGB 的结果编码后相同
+    Transition<Cube> transition;
+    Transition<Packed> packedTransition;
+    Effect<Cube> current = ConstantEffect(0x000000);
+    Effect<Packed> packedCurrent = ConstantEffect(0x000000);
+    transition.start(current, ConstantEffect(0xF8FCF8), direct, 100);
+    packedTransition.start(packedCurrent, ConstantEffect(0xF8FCF8), packed, 100);
+    CHECK(transition.update(current, direct, 30000));
+    CHECK(packedTransition.update(packedCurrent, packed, 30000));
+    packed.expand(expanded);
+    CHECK(direct.data()[0] != CRGB(0, 0, 0));
+    CHECK(same_as_rgb565(expanded, direct.data(), Cube::count()));
+}
+
+TEST(palette_cube_packs_to_nearest_entry) {
+    static PackedCube<8, 8, 8, Palette8> cube;
+    fill_solid(cube.data(), cube.count(), CRGB(250, 0, 0));
+    CHECK(cube.get(1, 2, 3) == CRGB(255, 0, 0));
+    cube.data()[5] = CRGB(0, 0, 255);
+    CHECK((CRGB) cube.data()[5] == CRGB(0, 0, 255));
+    CHECK_EQ(hash_frame(cube.data(), cube.count()) == hash_frame(cube.data(), cube.count() - 1), 0);
+}
+
+// 动画经预读缓冲或直接读入压缩帧, CSV 动画逐灯珠写入
+TEST(packed_cube_plays_animations) {
+    const char *files[] = {"panel.csv", "panel.anim", "panel_rle.anim", "panel_palette.anim"};
+    const uint32_t heaps[] = {20000, 0};
+    static LightCube<16, 16, 1> direct;
+    static PackedCube<16, 16, 1, Rgb565> packed;
+    static CRGB expanded[256];
+    for (uint32_t heap : heaps) {
+        ESP.maxFreeBlockSize = heap;
+        for (const char *file : files) {
+            AnimationEffect a(file), b(file);
+            for (int frame = 0; frame < 40; frame++) {
+                CHECK(a.update(direct, 16666));
+                CHECK(b.update(packed, 16666));
+                packed.expand(expanded);
+                CHECK(same_as_rgb565(expanded, direct.data(), 256));
+            }
+        }
+    }
+    ESP.maxFreeBlockSize = 20000;
+}
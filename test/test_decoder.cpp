@@ -0,0 +1,82 @@
+#include "test.h"
+
+#include "LightEffect.hpp"
+
+typedef LightStrip<256, false> Strip;
+
+static const char *const VARIANTS[] = {"_rle", "_palette", "_intra", "_noindex"};
+
+// 依次播放 frames 帧, 压缩动画与未压缩动画逐帧相同, 包括循环回首帧之后
+template <typename Light>
+static bool decodes_like_raw(const char *name, const char *variant, int frames) {
+    static Light a, b;
+    AnimationEffect raw((String(name) + ".anim").c_str());
+    AnimationEffect compressed((String(name) + variant + ".anim").c_str());
+    for (int i = 0; i < frames; i++) {
+        if (!raw.update(a, 16666) || !compressed.update(b, 16666) ||
+            memcmp(a.data(), b.data(), sizeof(CRGB) * a.count()) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST(decoder_matches_raw_frames) {
+    for (const char *variant : VARIANTS) {
+        CHECK((decodes_like_raw<Strip>("panel", variant, 1100)));
+        CHECK((decodes_like_raw<Strip>("example", variant, 40)));
+    }
+}
+
+// 灯珠比动画少时, 超出的像素解码后丢弃
+TEST(decoder_fewer_leds) {
+    for (const char *variant : VARIANTS) {
+        CHECK((decodes_like_raw<LightStrip<100, false>>("panel", variant, 100)));
+        CHECK((decodes_like_raw<LightStrip<10, false>>("example", variant, 40)));
+    }
+}
+
+TEST(decoder_reads_header_and_index) {
+    File file = LittleFS.open("/animations/panel_palette.anim", "r");
+    AnimHeader header;
+    CHECK(read_anim_header(file, header));
+    CHECK_EQ(header.format, ANIM_PALETTE_RLE);
+    CHECK(header.paletteSize > 0 && header.paletteSize <= 256);
+    AnimDecoder decoder;
+    CHECK(decoder.begin(file, header));
+    CHECK_EQ(file.position(), header.dataOffset());
+    CHECK_EQ(decoder.keyframeBefore(0), 0);
+    CHECK_EQ(decoder.keyframeBefore(59), 30);
+    CHECK_EQ(decoder.keyframeBefore(999), 990);
+    file.close();
+
+    file = LittleFS.open("/animations/panel_noindex.anim", "r");
+    CHECK(read_anim_header(file, header));
+    CHECK(decoder.begin(file, header));
+    CHECK_EQ(decoder.keyframeBefore(999), 0);
+}
+
+// 截断的文件在读不到数据时从头播放, 不会读出界
+TEST(decoder_truncated_file_restarts) {
+    File in = LittleFS.open("/animations/panel_rle.anim", "r");
+    File out = LittleFS.open("/animations/truncated.anim", "w");
+    uint8_t buffer[1000];
+    for (int i = 0; i < 20; i++) {
+        out.write(buffer, in.read(buffer, sizeof(buffer)));
+    }
+    out.close();
+    in.close();
+
+    static Strip light;
+    AnimationEffect effect("truncated.anim");
+    int played = 0, failed = 0;
+    for (int i = 0; i < 1000; i++) {
+        if (effect.update(light, 16666)) {
+            played++;
+        } else {
+            failed++;
+        }
+    }
+    CHECK(played > 0);
+    CHECK(failed > 0);
+}
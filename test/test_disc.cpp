@@ -0,0 +1,172 @@
+#include "test.h"
+
+#include "Light.hpp"
+
+// 原 LightDisc::at 的逐环求和, 作为偏移表的参照
+static int reference_index(const int *rings, int r, int arrangement, int ring, int i) {
+    if (arrangement & ANTICLOCKWISE) {
+        i = rings[ring] - i - 1;
+    }
+    int offset = 0;
+    if (arrangement & INSIDE_OUT) {
+        for (int k = ring + 1; k < r; k++) {
+            offset += rings[k];
+        }
+    } else {
+        for (int k = 0; k < ring; k++) {
+            offset += rings[k];
+        }
+    }
+    return offset + i;
+}
+
+template <int ARRANGEMENT, int... COUNT_PER_RING>
+static bool disc_matches() {
+    typedef LightDisc<ARRANGEMENT, COUNT_PER_RING...> Disc;
+    static Disc disc;
+    const int rings[] = {COUNT_PER_RING...};
+    const int r = sizeof...(COUNT_PER_RING);
+    int covered = 0;
+    for (int ring = 0; ring < r; ring++) {
+        LightRange range = disc.ring(ring);
+        if (range.size() != rings[ring] ||
+            range.begin() != disc.data() + reference_index(rings, r, ARRANGEMENT & INSIDE_OUT, ring, 0)) {
+            printf("  arrangement %d ring %d span differs\n", ARRANGEMENT, ring);
+            return false;
+        }
+        for (int i = 0; i < rings[ring]; i++) {
+            if (&disc.at(ring, i) != disc.data() + reference_index(rings, r, ARRANGEMENT, ring, i)) {
+                printf("  arrangement %d differs at (%d, %d)\n", ARRANGEMENT, ring, i);
+                return false;
+            }
+        }
+        covered += range.size();
+    }
+    return covered == Disc::count();
+}
+
+// 四种排列下偏移表和环的范围都与原逐环求和一致, 含单灯珠的中心环
+TEST(disc_offsets_match_per_ring_sum) {
+    CHECK((disc_matches<CLOCKWISE | OUTSIDE_IN, 12, 6, 3>()));
+    CHECK((disc_matches<ANTICLOCKWISE | OUTSIDE_IN, 12, 6, 3>()));
+    CHECK((disc_matches<CLOCKWISE | INSIDE_OUT, 12, 6, 3>()));
+    CHECK((disc_matches<ANTICLOCKWISE | INSIDE_OUT, 12, 6, 3>()));
+    CHECK((disc_matches<CLOCKWISE | INSIDE_OUT, 24, 16, 12, 8, 1>()));
+    CHECK((disc_matches<ANTICLOCKWISE | OUTSIDE_IN, 24, 16, 12, 8, 1>()));
+    CHECK((disc_matches<CLOCKWISE | OUTSIDE_IN, 5>()));
+}
+
+// fillSlice 只填满所在环, 与逐个 at() 赋值一致
+TEST(disc_fill_slice_matches_at) {
+    typedef LightDisc<ANTICLOCKWISE | INSIDE_OUT, 12, 6, 3> Disc;
+    Disc disc, expected;
+    for (int ring = 0; ring < disc.r(); ring++) {
+        fill_solid(disc.data(), Disc::count(), CRGB::Black);
+        fill_solid(expected.data(), Disc::count(), CRGB::Black);
+        disc.fillSlice(ring, CRGB(0x102030));
+        for (int i = 0; i < expected.l(ring); i++) {
+            expected.at(ring, i) = CRGB(0x102030);
+        }
+        CHECK(memcmp(disc.data(), expected.data(), sizeof(CRGB) * Disc::count()) == 0);
+    }
+}
+
+TEST(disc_for_each_ring_visits_rings_in_order) {
+    LightDisc<CLOCKWISE | INSIDE_OUT, 12, 6, 3> disc;
+    int next = 0;
+    int total = 0;
+    bool ordered = true;
+    disc.forEachRing([&](int ring, LightRange range) {
+        ordered = ordered && ring == next++ && range.size() == disc.l(ring);
+        total += range.size();
+    });
+    CHECK(ordered);
+    CHECK_EQ(next, 3);
+    CHECK_EQ(total, 21);
+}
+
+// at(ring, i) 的角度按 i 均分一周, 半径与灯珠数成正比
+template <int ARRANGEMENT>
+static bool polars_match() {
+    typedef LightDisc<ARRANGEMENT, 12, 6, 3, 1> Disc;
+    static Disc disc;
+    for (int ring = 0; ring < disc.r(); ring++) {
+        int n = disc.l(ring);
+        for (int i = 0; i < n; i++) {
+            int index = &disc.at(ring, i) - disc.data();
+            if (Disc::angle(index) != i * 256 / n || Disc::radius(index) != n * 255 / 12) {
+                printf("  arrangement %d differs at (%d, %d)\n", ARRANGEMENT, ring, i);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+TEST(disc_polar_table_matches_rings) {
+    CHECK(polars_match<CLOCKWISE | OUTSIDE_IN>());
+    CHECK(polars_match<ANTICLOCKWISE | OUTSIDE_IN>());
+    CHECK(polars_match<CLOCKWISE | INSIDE_OUT>());
+    CHECK(polars_match<ANTICLOCKWISE | INSIDE_OUT>());
+}
+
+TEST(disc_shade_pixels_uses_polars) {
+    typedef LightDisc<ANTICLOCKWISE | INSIDE_OUT, 12, 6, 3> Disc;
+    Disc disc;
+    disc.shadePixels([](LightPoint p) { return CRGB(p.x, p.y, 0); });
+    for (int i = 0; i < Disc::count(); i++) {
+        CHECK(disc.data()[i] == CRGB(Disc::angle(i), Disc::radius(i), 0));
+    }
+}
+
+// 逐个灯珠按角度判断是否在 [from, to) 中, to <= from 时跨过 0 度, 相等时为整周
+template <typename Disc>
+static bool sector_matches(uint8_t from, uint8_t to) {
+    static Disc disc;
+    int visits[Disc::count()] = {};
+    disc.forEachInSector(from, to, [&](CRGB &led) { visits[&led - disc.data()]++; });
+    int width = to > from ? to - from : to - from + 256;
+    for (int i = 0; i < Disc::count(); i++) {
+        int expected = (uint8_t) (Disc::angle(i) - from) < width ? 1 : 0;
+        if (visits[i] != expected) {
+            printf("  sector [%d, %d) LED %d visited %d times\n", from, to, i, visits[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename Disc>
+static int sector_size(uint8_t from, uint8_t to) {
+    static Disc disc;
+    int n = 0;
+    disc.forEachInSector(from, to, [&](CRGB &) { n++; });
+    return n;
+}
+
+TEST(disc_sector_matches_angles) {
+    typedef LightDisc<ANTICLOCKWISE | INSIDE_OUT, 12, 6, 3, 1> Disc;
+    typedef LightDisc<CLOCKWISE | OUTSIDE_IN, 24, 16, 12, 8, 1> Large;
+    bool all = true;
+    for (int from = 0; from < 256; from += 7) {
+        for (int to = 0; to < 256; to += 11) {
+            all = all && sector_matches<Disc>(from, to) && sector_matches<Large>(from, to);
+        }
+    }
+    CHECK(all);
+}
+
+TEST(disc_sector_edge_cases) {
+    typedef LightDisc<CLOCKWISE | OUTSIDE_IN, 12, 6, 3, 1> Disc;
+    // 跨过 0 度: 12 环的 11, 0, 1, 其余各环的 0
+    CHECK(sector_matches<Disc>(224, 32));
+    CHECK_EQ(sector_size<Disc>(224, 32), 3 + 1 + 1 + 1);
+    // 两个灯珠之间的扇区为空
+    CHECK(sector_matches<Disc>(1, 21));
+    CHECK_EQ(sector_size<Disc>(1, 21), 0);
+    // from == to 为整周, 每个灯珠恰好一次
+    CHECK(sector_matches<Disc>(0, 0));
+    CHECK(sector_matches<Disc>(200, 200));
+    CHECK_EQ(sector_size<Disc>(200, 200), Disc::count());
+    CHECK_EQ(sector_size<Disc>(255, 255), Disc::count());
+}
@@ -0,0 +1,42 @@
+#include "test.h"
+
+#include "LightEffect.hpp"
+
+typedef LightStrip<30, false> Strip;
+
+// 按 EffectType 顺序排列的命令参数
+static const char *EFFECT_ARGS[EFFECT_TYPE_COUNT][3] = {
+    {"#FF0000"},
+    {"#00FF00", "0.5", "0.5"},
+    {"#0000FF", "1", "0.5"},
+    {"#FFFFFF", "1", "0.1"},
+    {"5"},
+    {"1", "3"},
+    {"missing.csv"},
+    {"1"},
+    {},
+};
+
+// 切换除动画外的所有灯效, 动画会打开文件和创建播放器, 见 test_lifetime.cpp
+TEST(effect_switch_allocates_nothing) {
+    Strip light;
+    Effect<Strip> effect = ConstantEffect(DEFAULT_COLOR);
+    const EffectType types[] = {CONSTANT, BLINK, BREATH, CHASE, RAINBOW, STREAM, MUSIC, CUSTOM};
+    uint64_t before = test_allocations();
+    for (int i = 0; i < 10000; i++) {
+        EffectType type = types[i % ARRAY_LENGTH(types)];
+        effect = Effect<Strip>::create(type, 3, EFFECT_ARGS[type]);
+        effect.update(light, 16666);
+        CHECK_EQ(effect.type(), type);
+    }
+    CHECK_EQ(test_allocations() - before, 0);
+}
+
+TEST(effect_move_keeps_state) {
+    Strip light;
+    Effect<Strip> a = ConstantEffect(0x123456);
+    Effect<Strip> b = std::move(a);
+    CHECK_EQ(b.type(), CONSTANT);
+    CHECK(b.update(light, 0));
+    CHECK(light.data()[0] == CRGB(0x123456));
+}
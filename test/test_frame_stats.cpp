@@ -0,0 +1,52 @@
+#include "test.h"
+
+#include "LightCompositor.hpp"
+
+typedef LightStrip<30, false> Strip;
+
+// 30 个灯珠共 90 字节, 最后 2 字节不足一个字, 也要参与哈希
+TEST(hash_frame_detects_any_byte) {
+    static Strip a, b;
+    fill_solid(a.data(), a.count(), CRGB(0x123456));
+    fill_solid(b.data(), b.count(), CRGB(0x123456));
+    uint32_t hash = hash_frame(a.data(), a.count());
+    CHECK_EQ(hash_frame(b.data(), b.count()), hash);
+    for (int i = 0; i < (int) (a.count() * sizeof(CRGB)); i++) {
+        uint8_t *bytes = reinterpret_cast<uint8_t *>(b.data());
+        bytes[i] ^= 1;
+        CHECK(hash_frame(b.data(), b.count()) != hash);
+        bytes[i] ^= 1;
+    }
+    // 交换两个灯珠也会改变哈希
+    b.data()[0] = CRGB(0x654321);
+    b.data()[1] = CRGB(0x123456);
+    a.data()[0] = CRGB(0x123456);
+    a.data()[1] = CRGB(0x654321);
+    CHECK(hash_frame(a.data(), a.count()) != hash_frame(b.data(), b.count()));
+}
+
+TEST(frame_stats_push_only_changed_frames) {
+    FrameStats stats = {};
+    static Strip light;
+    CHECK(!stats.push());
+
+    fill_solid(light.data(), light.count(), CRGB(0x102030));
+    stats.render(hash_frame(light.data(), light.count()));
+    CHECK(stats.push());
+    CHECK(!stats.push());
+
+    // 灯效报告变化但画面相同, 计入渲染但不刷新
+    stats.render(hash_frame(light.data(), light.count()));
+    CHECK(!stats.push());
+
+    light.data()[7] = CRGB(0x102031);
+    stats.render(hash_frame(light.data(), light.count()));
+    // 输出前又渲染了一帧, 只刷新一次
+    light.data()[7] = CRGB(0x102032);
+    stats.render(hash_frame(light.data(), light.count()));
+    CHECK(stats.push());
+    CHECK(!stats.push());
+
+    CHECK_EQ(stats.rendered, 4);
+    CHECK_EQ(stats.pushed, 2);
+}
@@ -0,0 +1,165 @@
+#include "test.h"
+
+#include "LightEffect.hpp"
+#include "LightLayout.hpp"
+
+typedef LightLayout<512> Layout;
+
+// 切片颜色为切片序号, 检查每个切片覆盖的灯珠
+template <typename Light>
+static void fill_slices(Light &light) {
+    for (int i = 0; i < light.slices(); i++) {
+        light.fillSlice(i, CRGB(i, i >> 8, 1));
+    }
+}
+
+template <typename Fixed>
+static bool slices_match(Layout &layout, Fixed &fixed) {
+    if (layout.count() != fixed.count() || layout.slices() != fixed.slices()) {
+        return false;
+    }
+    fill_slices(layout);
+    fill_slices(fixed);
+    return memcmp(layout.data(), fixed.data(), fixed.count() * sizeof(CRGB)) == 0;
+}
+
+TEST(layout_strip_matches_fixed) {
+    StaticJsonDocument<256> json;
+    json["type"] = "strip";
+    json["count"] = 30;
+    json["reverse"] = true;
+    CHECK(Layout::readFromJSON(json));
+    static Layout layout;
+    LightStrip<30, true> strip;
+    CHECK(slices_match(layout, strip));
+    for (int i = 0; i < 30; i++) {
+        CHECK_EQ(&layout.at(i) - layout.data(), &strip.at(i) - strip.data());
+    }
+}
+
+TEST(layout_panel_matches_fixed) {
+    StaticJsonDocument<256> json;
+    json["type"] = "panel";
+    json["width"] = 7;
+    json["height"] = 5;
+    json["arrangement"] = SNAKE | VERTICAL | MIRROR;
+    CHECK(Layout::readFromJSON(json));
+    static Layout layout;
+    LightPanel<7, 5, SNAKE | VERTICAL | MIRROR> panel;
+    CHECK(slices_match(layout, panel));
+    for (int y = 0; y < 5; y++) {
+        for (int x = 0; x < 7; x++) {
+            CHECK_EQ(&layout.at(y * 7 + x) - layout.data(), &panel.at(x, y) - panel.data());
+        }
+    }
+}
+
+TEST(layout_disc_matches_fixed) {
+    StaticJsonDocument<256> json;
+    json["type"] = "disc";
+    json["arrangement"] = ANTICLOCKWISE | INSIDE_OUT;
+    JsonArray rings = json.createNestedArray("rings");
+    rings.add(12);
+    rings.add(6);
+    rings.add(3);
+    CHECK(Layout::readFromJSON(json));
+    static Layout layout;
+    LightDisc<ANTICLOCKWISE | INSIDE_OUT, 12, 6, 3> disc;
+    CHECK(slices_match(layout, disc));
+    const int starts[] = {0, 12, 18};
+    for (int ring = 0; ring < 3; ring++) {
+        for (int i = 0; i < disc.l(ring); i++) {
+            CHECK_EQ(&layout.at(starts[ring] + i) - layout.data(), &disc.at(ring, i) - disc.data());
+        }
+    }
+}
+
+TEST(layout_rejects_invalid_topology) {
+    StaticJsonDocument<256> json;
+    json["type"] = "strip";
+    json["count"] = 513;
+    CHECK_EQ(Layout::countOf(json), 0);
+    CHECK(!Layout::readFromJSON(json));
+
+    json.clear();
+    json["type"] = "panel";
+    json["width"] = 16;
+    json["height"] = 0;
+    CHECK_EQ(Layout::countOf(json), 0);
+
+    json.clear();
+    json["type"] = "disc";
+    JsonArray rings = json.createNestedArray("rings");
+    rings.add(12);
+    rings.add(-1);
+    CHECK_EQ(Layout::countOf(json), 0);
+
+    json.clear();
+    json["type"] = "cube";
+    CHECK_EQ(Layout::countOf(json), 0);
+}
+
+TEST(layout_json_round_trip) {
+    StaticJsonDocument<256> json, saved;
+    json["type"] = "disc";
+    json["arrangement"] = CLOCKWISE | OUTSIDE_IN;
+    JsonArray rings = json.createNestedArray("rings");
+    rings.add(8);
+    rings.add(4);
+    CHECK(Layout::readFromJSON(json));
+    Layout::writeToJSON(saved);
+    CHECK(strcmp(saved["type"], "disc") == 0);
+    CHECK_EQ(saved["rings"].size(), 2);
+    CHECK_EQ(saved["capacity"].as<int>(), 512);
+
+    Layout::readFromJSON(saved);
+    CHECK_EQ(Layout::count(), 12);
+    CHECK_EQ(Layout::slices(), 2);
+}
+
+// 文件不存在或无法解析时退回满容量的灯带
+TEST(layout_load_falls_back_to_strip) {
+    CHECK(!Layout::load("/missing_layout.json"));
+    CHECK_EQ(Layout::type(), LAYOUT_STRIP);
+    CHECK_EQ(Layout::count(), 512);
+}
+
+// shade 对运行时形态走整段填充或逐个查表, 结果与编译期形态相同
+template <typename Fixed>
+static bool shade_matches(JsonDocument &json) {
+    static Layout layout;
+    static Fixed fixed;
+    if (!Layout::readFromJSON(json)) {
+        return false;
+    }
+    auto shader = [](int slice) { return CRGB(slice, 255 - slice, 7); };
+    shade(layout, shader);
+    shade(fixed, shader);
+    return memcmp(layout.data(), fixed.data(), fixed.count() * sizeof(CRGB)) == 0;
+}
+
+TEST(layout_shade_matches_fixed) {
+    StaticJsonDocument<256> json;
+    json["type"] = "strip";
+    json["count"] = 30;
+    json["reverse"] = true;
+    CHECK((shade_matches<LightStrip<30, true>>(json)));
+
+    json.clear();
+    json["type"] = "panel";
+    json["width"] = 7;
+    json["height"] = 5;
+    json["arrangement"] = SNAKE | HORIZONTAL | FLIP;
+    CHECK((shade_matches<LightPanel<7, 5, SNAKE | HORIZONTAL | FLIP>>(json)));
+    json["arrangement"] = Z_WORD | VERTICAL;
+    CHECK((shade_matches<LightPanel<7, 5, Z_WORD | VERTICAL>>(json)));
+
+    json.clear();
+    json["type"] = "disc";
+    json["arrangement"] = ANTICLOCKWISE | OUTSIDE_IN;
+    JsonArray rings = json.createNestedArray("rings");
+    rings.add(12);
+    rings.add(6);
+    rings.add(1);
+    CHECK((shade_matches<LightDisc<ANTICLOCKWISE | OUTSIDE_IN, 12, 6, 1>>(json)));
+}
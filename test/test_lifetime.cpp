@@ -0,0 +1,60 @@
+#include "test.h"
+
+#include <sys/stat.h>
+
+#include "LightEffect.hpp"
+
+typedef LightStrip<30, false> Strip;
+
+// 写入一个两帧的 CSV 动画
+static void write_animation(const char *name) {
+    mkdir("fsroot/animations", 0755);
+    File file = LittleFS.open(String("/animations/") + name, "w");
+    for (int frame = 0; frame < 2; frame++) {
+        for (int i = 0; i < 30; i++) {
+            file.write((const uint8_t *) (i < 29 ? "#102030," : "#102030\n"), 8);
+        }
+    }
+}
+
+// 不断切换包括动画在内的所有灯效, 灯效和文件句柄都不能泄漏
+TEST(effect_lifetime_100k_switches) {
+    write_animation("lifetime.csv");
+    Strip light;
+    const char *args[EFFECT_TYPE_COUNT][3] = {
+        {"#FF0000"}, {"#00FF00", "0.5", "0.5"}, {"#0000FF", "1", "0.5"}, {"#FFFFFF", "1", "0.1"},
+        {"5"}, {"1", "3"}, {"lifetime.csv"}, {"1"}, {},
+    };
+    uint32_t created = EffectCounters::created, destroyed = EffectCounters::destroyed;
+    uint64_t live = test_live_allocations();
+    {
+        Effect<Strip> effect = ConstantEffect(DEFAULT_COLOR);
+        for (int i = 0; i < 100000; i++) {
+            EffectType type = (EffectType) (i % EFFECT_TYPE_COUNT);
+            effect = Effect<Strip>::create(type, 3, args[type]);
+            effect.update(light, 16666);
+            CHECK_EQ(EffectCounters::alive(), 1);
+            CHECK_EQ(EffectCounters::openFiles, type == ANIMATION);
+            CHECK_EQ(File::opened(), type == ANIMATION);
+        }
+        effect = ConstantEffect(DEFAULT_COLOR);
+        CHECK_EQ(EffectCounters::openFiles, 0);
+        CHECK_EQ(File::opened(), 0);
+    }
+    CHECK_EQ(EffectCounters::alive(), 0);
+    CHECK(EffectCounters::created - created >= 100000);
+    CHECK_EQ(EffectCounters::created - created, EffectCounters::destroyed - destroyed);
+    CHECK_EQ(test_live_allocations(), live);
+}
+
+// 打开失败的动画不占用文件句柄
+TEST(effect_lifetime_missing_animation) {
+    Strip light;
+    {
+        Effect<Strip> effect = AnimationEffect("missing.csv");
+        CHECK(!effect.update(light, 16666));
+        CHECK_EQ(EffectCounters::openFiles, 0);
+        CHECK_EQ(File::opened(), 0);
+    }
+    CHECK_EQ(EffectCounters::alive(), 0);
+}
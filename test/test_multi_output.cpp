@@ -0,0 +1,112 @@
+#include "test.h"
+
+#include "LightCompositor.hpp"
+
+typedef LightPanel<8, 8, SNAKE | HORIZONTAL> Panel;
+typedef MultiOutput<Panel, LightPanel<8, 2, SNAKE | HORIZONTAL>, 4> Multi;
+
+static bool supports_strip = SupportsMultiOutput<LightStrip<30, false>>::value;
+static bool supports_disc = SupportsMultiOutput<LightDisc<CLOCKWISE | OUTSIDE_IN, 12, 6>>::value;
+
+TEST(multi_output_supports_strip_and_panel_only) {
+    CHECK(supports_strip);
+    CHECK(!supports_disc);
+}
+
+// 每路的灯珠序号与单独的 8x2 灯板相同
+TEST(multi_output_rearranges_by_output) {
+    static Multi light;
+    CRGB out[64];
+    for (int i = 0; i < 64; i++) {
+        light.data()[i] = CRGB(i, 0, 0);
+    }
+    copy_to_output(light, out, light.data());
+    LightPanel<8, 2, SNAKE | HORIZONTAL> part;
+    for (int output = 0; output < 4; output++) {
+        for (int y = 0; y < 2; y++) {
+            for (int x = 0; x < 8; x++) {
+                int index = &part.at(x, y) - part.data();
+                CHECK_EQ(out[output * 16 + index].r, &light.at(x, output * 2 + y) - light.data());
+            }
+        }
+    }
+}
+
+// 分段按逻辑序号给出, 叠加时需与整帧一样按输出重排
+TEST(multi_output_segments_overlay_mapped) {
+    static Multi light;
+    Segments<Multi, 2> segments;
+    CRGB expected[64], out[64];
+    for (int i = 0; i < 64; i++) {
+        light.data()[i] = CRGB(0, 0, i);
+    }
+    CHECK(segments.set(light, 0, "a", 5, 20, ConstantEffect(0xFF0000)));
+    CHECK(segments.set(light, 1, "b", 40, 3, ConstantEffect(0x00FF00)));
+    segments.setBrightness(1, 127);
+    CHECK(segments.update(16666));
+    copy_to_output(light, out, light.data());
+    segments.overlay(light, out);
+
+    fill_solid(light.data() + 5, 20, CRGB(0xFF0000));
+    fill_solid(light.data() + 40, 3, CRGB(0x007F00));
+    copy_to_output(light, expected, light.data());
+    CHECK(memcmp(out, expected, sizeof(out)) == 0);
+}
+
+/**
+ * 并行控制器的位流模型: 各路缓冲依次排列, 每个时隙按 GRB 顺序从高位起
+ * 输出 24 位, 第 k 位同时写到 GPIO12+k 上, 与 FastLED 的 WS2811_PORTA 的转置一致
+ */
+static void encode_parallel(const CRGB *leds, int outputs, int countPerOutput, uint8_t *port) {
+    for (int i = 0; i < countPerOutput; i++) {
+        for (int byte = 0; byte < 3; byte++) {
+            for (int bit = 7; bit >= 0; bit--) {
+                uint8_t word = 0;
+                for (int k = 0; k < outputs; k++) {
+                    const CRGB &led = leds[k * countPerOutput + i];
+                    uint8_t value = byte == 0 ? led.g : byte == 1 ? led.r : led.b;
+                    word |= (value >> bit & 1) << k;
+                }
+                *port++ = word;
+            }
+        }
+    }
+}
+
+// 从端口位流中取出第 pin 路第 i 个灯珠收到的颜色
+static CRGB decode_pin(const uint8_t *port, int pin, int i) {
+    uint32_t grb = 0;
+    for (int bit = 0; bit < 24; bit++) {
+        grb = grb << 1 | (port[i * 24 + bit] >> pin & 1);
+    }
+    return CRGB(grb >> 8 & 0xFF, grb >> 16, grb & 0xFF);
+}
+
+// 每路第 i 个灯珠收到的是该路接线顺序上第 i 个位置的逻辑像素
+template <typename Light, typename Output, int OUTPUTS>
+static bool pins_receive_wiring_order() {
+    typedef MultiOutput<Light, Output, OUTPUTS> Multi;
+    static DoubleBuffer<Multi> light;
+    static uint8_t port[Light::count() * 24];
+    for (int i = 0; i < Light::count(); i++) {
+        light.data()[i] = CRGB(i, 255 - i, i * 7);
+    }
+    light.swap();
+    encode_parallel(light.front(), OUTPUTS, Multi::countPerOutput(), port);
+    for (int pin = 0; pin < OUTPUTS; pin++) {
+        for (int i = 0; i < Output::count(); i++) {
+            int index = Light::indexOf(pin * Output::count() + Output::positionOf(i));
+            if (decode_pin(port, pin, i) != light.data()[index]) {
+                printf("  pin %d LED %d differs\n", pin, i);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+TEST(multi_output_bitstream_follows_wiring_order) {
+    CHECK((pins_receive_wiring_order<Panel, LightPanel<8, 2, SNAKE | HORIZONTAL>, 4>()));
+    CHECK((pins_receive_wiring_order<LightPanel<8, 8, VERTICAL | FLIP>, LightPanel<8, 2, SNAKE | VERTICAL>, 4>()));
+    CHECK((pins_receive_wiring_order<LightStrip<30, false>, LightStrip<10, true>, 3>()));
+}
@@ -0,0 +1,55 @@
+#include "test.h"
+
+#include "Light.hpp"
+
+// 原 LightPanel::at 的逐像素计算, 作为索引表的参照
+static int reference_index(int w, int h, int arrangement, int x, int y) {
+    if (arrangement & VERTICAL) {
+        std::swap(x, y);
+        std::swap(w, h);
+    }
+    if ((arrangement & SNAKE) && y % 2 == 1) {
+        x = w - x - 1;
+    }
+    if (arrangement & MIRROR) {
+        x = w - x - 1;
+    }
+    if (arrangement & FLIP) {
+        y = h - y - 1;
+    }
+    return y * w + x;
+}
+
+template <int W, int H, int ARRANGEMENT>
+static bool panel_matches() {
+    typedef LightPanel<W, H, ARRANGEMENT> Panel;
+    static Panel panel;
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            int index = reference_index(W, H, ARRANGEMENT, x, y);
+            if (&panel.at(x, y) != panel.data() + index || Panel::positionOf(index) != y * W + x ||
+                &panel.row(y)[x] != panel.data() + index || &panel.column(x)[y] != panel.data() + index) {
+                printf("  %dx%d arrangement %d differs at (%d, %d)\n", W, H, ARRANGEMENT, x, y);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template <int W, int H>
+static bool all_arrangements_match() {
+    return panel_matches<W, H, 0>() && panel_matches<W, H, 1>() && panel_matches<W, H, 2>() &&
+           panel_matches<W, H, 3>() && panel_matches<W, H, 4>() && panel_matches<W, H, 5>() &&
+           panel_matches<W, H, 6>() && panel_matches<W, H, 7>() && panel_matches<W, H, 8>() &&
+           panel_matches<W, H, 9>() && panel_matches<W, H, 10>() && panel_matches<W, H, 11>() &&
+           panel_matches<W, H, 12>() && panel_matches<W, H, 13>() && panel_matches<W, H, 14>() &&
+           panel_matches<W, H, 15>();
+}
+
+// 16 种排列方式下索引表, 行列迭代器和逆映射都与原实现一致, 含非正方形和奇数行列
+TEST(panel_table_matches_reference) {
+    CHECK((all_arrangements_match<16, 16>()));
+    CHECK((all_arrangements_match<7, 5>()));
+    CHECK((all_arrangements_match<4, 9>()));
+}
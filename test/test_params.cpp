@@ -0,0 +1,92 @@
+#include "test.h"
+
+#include "LightEffect.hpp"
+
+typedef LightStrip<30, false> Strip;
+
+TEST(parse_param_checks_range_and_format) {
+    float f = 0;
+    CHECK(parse_param("1.5", f) && f == 1.5f);
+    CHECK(!parse_param("1.5x", f) && f == 1.5f);
+    CHECK(!parse_param("", f));
+
+    int8_t i8 = 0;
+    CHECK(parse_param("-128", i8) && i8 == -128);
+    CHECK(!parse_param("128", i8) && i8 == -128);
+
+    uint8_t u8 = 0;
+    CHECK(parse_param("255", u8) && u8 == 255);
+    CHECK(!parse_param("256", u8));
+    CHECK(!parse_param("-1", u8));
+
+    uint32_t u32 = 0;
+    CHECK(parse_param("2147483647", u32) && u32 == 2147483647u);
+    CHECK(!parse_param("-1", u32));
+
+    bool b = false;
+    CHECK(parse_param("1", b) && b);
+    CHECK(!parse_param("2", b));
+
+    CRGB color;
+    CHECK(parse_param("#a0B1c2", color) && color == CRGB(0xA0B1C2));
+    CHECK(!parse_param("a0b1c2", color));
+    CHECK(!parse_param("#12345", color));
+    CHECK(!parse_param("#12345g", color));
+    CHECK(color == CRGB(0xA0B1C2));
+}
+
+// 名称不符或取值无效时不修改字段
+TEST(set_param_matches_key_then_value) {
+    uint8_t direction = 3;
+    CHECK(!set_param("delta", "1", "direction", direction));
+    CHECK(!set_param("direction", "300", "direction", direction));
+    CHECK_EQ(direction, 3);
+    CHECK(set_param("direction", "1", "direction", direction));
+    CHECK_EQ(direction, 1);
+}
+
+// 修改步长后位置不变, 当前步内已走过的比例也不变
+TEST(chase_rescale_keeps_position) {
+    const char *args[] = {"#FF0000", "0", "0.1"};
+    ChaseEffect chase = ChaseEffect::fromArgs(3, args);
+    Strip light;
+    CHECK(chase.update(light, 750000));
+    CHECK(light.data()[7] == CRGB(0xFF0000));
+
+    CHECK(chase.set("lastTime", "0.2"));
+    CHECK(!chase.update(light, 0));
+    CHECK(!chase.update(light, 99999)); // 半步为 100000 us
+    CHECK(light.data()[7] == CRGB(0xFF0000));
+    CHECK(chase.update(light, 1));
+    CHECK(light.data()[8] == CRGB(0xFF0000));
+    CHECK(light.data()[7] == CRGB(CRGB::Black));
+}
+
+// hue_time 是 hue_at 的逆运算, 任意速度下都能接上当前色相
+TEST(hue_time_inverts_hue_at) {
+    for (int delta = -128; delta < 128; delta++) {
+        if (delta == 0) {
+            continue;
+        }
+        for (int hue = 0; hue < 256; hue++) {
+            uint32_t time = hue_time(hue, delta);
+            CHECK_EQ(hue_at(time, 0, delta), hue);
+        }
+    }
+}
+
+TEST(rainbow_speed_change_keeps_hue) {
+    const char *args[] = {"5"};
+    RainbowEffect rainbow = RainbowEffect::fromArgs(1, args);
+    Strip light;
+    CHECK(rainbow.update(light, 1234567));
+    CRGB before = light.data()[0];
+    const char *speeds[] = {"-3", "127", "-128", "1"};
+    for (const char *speed : speeds) {
+        CHECK(rainbow.set("delta", speed));
+        CHECK(!rainbow.update(light, 0)); // 色相未变, 无需重绘
+        CHECK(light.data()[0] == before);
+        CHECK(rainbow.update(light, 50000));
+        before = light.data()[0];
+    }
+}
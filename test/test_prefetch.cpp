@@ -0,0 +1,64 @@
+#include "test.h"
+
+#include "LightEffect.hpp"
+
+typedef LightStrip<256, false> Strip;
+
+static const char *const VARIANTS[] = {"panel.anim", "panel_rle.anim", "panel_palette.anim"};
+
+// 每帧之间预读时, 与不预读时逐帧相同, 且首帧之后不再欠载
+TEST(prefetch_matches_direct_playback) {
+    static Strip a, b;
+    for (const char *name : VARIANTS) {
+        AnimationEffect direct(name);
+        ESP.maxFreeBlockSize = 0; // 内存不足时不分配预读缓冲
+        AnimationEffect prefetched(name);
+        ESP.maxFreeBlockSize = 20000;
+        AnimPlayer::pollAll();
+        uint32_t underruns = AnimPlayer::underruns;
+        for (int i = 0; i < 1500; i++) {
+            CHECK(direct.update(a, 16666));
+            CHECK(prefetched.update(b, 16666));
+            CHECK(memcmp(a.data(), b.data(), sizeof(a)) == 0);
+            if (i == 700) {
+                CHECK(prefetched.set("frame", "100"));
+                CHECK(direct.set("frame", "100"));
+            }
+            AnimPlayer::pollAll();
+            AnimPlayer::pollAll();
+        }
+        CHECK_EQ(AnimPlayer::underruns, underruns);
+
+        // 跳转后来不及预读时, 刷新时直接读取并计为欠载
+        CHECK(prefetched.set("frame", "500"));
+        CHECK(direct.set("frame", "500"));
+        CHECK(direct.update(a, 16666));
+        CHECK(prefetched.update(b, 16666));
+        CHECK(memcmp(a.data(), b.data(), sizeof(a)) == 0);
+        CHECK_EQ(AnimPlayer::underruns - underruns, 1);
+    }
+}
+
+// 预读缓冲按可用内存分配, 状态统计所有播放中的动画
+TEST(prefetch_ring_sized_by_heap) {
+    uint32_t depth, capacity;
+    ESP.maxFreeBlockSize = ANIM_PREFETCH_HEAP_RESERVE + 3 * 256 * sizeof(CRGB);
+    {
+        AnimationEffect effect("panel.anim");
+        AnimPlayer::stats(depth, capacity);
+        CHECK_EQ(capacity, 3);
+        CHECK_EQ(depth, 0);
+        AnimPlayer::pollAll();
+        AnimPlayer::pollAll();
+        AnimPlayer::stats(depth, capacity);
+        CHECK_EQ(depth, 2);
+
+        ESP.maxFreeBlockSize = ANIM_PREFETCH_HEAP_RESERVE + 256 * sizeof(CRGB);
+        AnimationEffect small("panel.anim");
+        AnimPlayer::stats(depth, capacity);
+        CHECK_EQ(capacity, 3); // 只能放下一帧时不预读
+    }
+    ESP.maxFreeBlockSize = 20000;
+    AnimPlayer::stats(depth, capacity);
+    CHECK_EQ(capacity, 0);
+}
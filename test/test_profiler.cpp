@@ -0,0 +1,36 @@
+#include "test.h"
+
+#define ENABLE_PROFILER
+#include "Profiler.hpp"
+
+static const __FlashStringHelper *stage_name(int stage) {
+    return (const __FlashStringHelper *) (stage == PERF_COMPOSE ? "compose" : "show");
+}
+
+// 百分位取所在桶的上界, 与真实值相差不到一倍, 且不超过最大值
+TEST(profiler_percentiles_from_histogram) {
+    static Profiler profiler;
+    for (int i = 0; i < 1000; i++) {
+        profiler.record(PERF_COMPOSE, i < 980 ? 100 + i % 20 : 50000);
+    }
+    CHECK_EQ(profiler.percentile(PERF_COMPOSE, 50), 127);
+    CHECK_EQ(profiler.percentile(PERF_COMPOSE, 98), 127);
+    CHECK_EQ(profiler.percentile(PERF_COMPOSE, 99), 50000);
+
+    profiler.record(PERF_SHOW, 0);
+    profiler.record(PERF_SHOW, 0);
+    profiler.record(PERF_SHOW, 3000);
+    CHECK_EQ(profiler.percentile(PERF_SHOW, 50), 0);
+    CHECK_EQ(profiler.percentile(PERF_SHOW, 99), 3000);
+
+    StaticJsonDocument<1024> json;
+    profiler.writeToJSON(json, stage_name);
+    CHECK_EQ(json["stages"]["compose"]["count"].as<int>(), 1000);
+    CHECK_EQ(json["stages"]["compose"]["p50"].as<int>(), 127);
+    CHECK_EQ(json["stages"]["compose"]["p99"].as<int>(), 50000);
+    CHECK_EQ(json["stages"]["show"]["min"].as<int>(), 0);
+
+    profiler.reset();
+    profiler.record(PERF_COMPOSE, 5);
+    CHECK_EQ(profiler.percentile(PERF_COMPOSE, 99), 5);
+}
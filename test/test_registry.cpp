@@ -0,0 +1,48 @@
+#include "test.h"
+
+#include "LightEffect.hpp"
+
+static const char *const NAMES[EFFECT_TYPE_COUNT] = {
+    "constant", "blink", "breath", "chase", "rainbow", "stream", "animation", "music", "custom",
+};
+
+TEST(registry_names_round_trip) {
+    for (int i = 0; i < EFFECT_TYPE_COUNT; i++) {
+        CHECK(strcmp(effect2str((EffectType) i), NAMES[i]) == 0);
+        CHECK_EQ(str2effect(NAMES[i]), i);
+        CHECK_EQ(Effects::find(effect2str((EffectType) i)), i);
+        CHECK(strlen(effect2args((EffectType) i)) > 0 || i == CUSTOM);
+    }
+    CHECK(strcmp(effect2str(EFFECT_TYPE_COUNT), "") == 0);
+}
+
+// 每个名称占用散列表中不同的槽位, 查找只需一次比较
+TEST(registry_hash_is_perfect) {
+    bool used[EFFECT_HASH_SIZE] = {};
+    for (int i = 0; i < EFFECT_TYPE_COUNT; i++) {
+        uint32_t slot = name_hash(NAMES[i], Effects::SEED) % EFFECT_HASH_SIZE;
+        CHECK(!used[slot]);
+        used[slot] = true;
+        CHECK_EQ(Effects::slotIndex(slot), i);
+    }
+    for (int slot = 0; slot < EFFECT_HASH_SIZE; slot++) {
+        CHECK(used[slot] || Effects::slotIndex(slot) == 0xFF);
+    }
+}
+
+TEST(registry_rejects_unknown_names) {
+    const char *unknown[] = {"", "Constant", "const", "constants", "rainbow ", "musi", "off", "layer", "xyz"};
+    for (const char *name : unknown) {
+        CHECK_EQ(str2effect(name), EFFECT_TYPE_COUNT);
+    }
+    // 所有长度不超过 3 的小写名称都不能误判为灯效
+    char name[4] = {};
+    for (int a = 'a'; a <= 'z'; a++) {
+        for (int b = 0; b <= 26; b++) {
+            name[0] = a;
+            name[1] = b ? 'a' + b - 1 : '\0';
+            name[2] = b ? 'a' + (a + b) % 26 : '\0';
+            CHECK_EQ(str2effect(name), EFFECT_TYPE_COUNT);
+        }
+    }
+}
@@ -0,0 +1,109 @@
+#include "test.h"
+
+#include "FrameScheduler.hpp"
+#include "Light.hpp"
+
+typedef LightStrip<30, false> Strip;
+
+// 每帧都准时到达时截止时间按周期前进, 中途改变帧率也不会后退
+TEST(scheduler_rate_change_keeps_deadlines_monotonic) {
+    FrameScheduler scheduler;
+    scheduler.setRate(60);
+    uint32_t last = scheduler.nextDeadline();
+    for (int i = 0; i < 300; i++) {
+        if (i == 100) {
+            scheduler.setRate(120);
+        } else if (i == 200) {
+            scheduler.setRate(30);
+        }
+        uint32_t now = scheduler.nextDeadline();
+        int32_t delta = (int32_t) (now - last);
+        CHECK(delta >= 0);
+        CHECK(delta <= 1000000 / 30 + 1);
+        last = now;
+        scheduler.next(now);
+    }
+    CHECK_EQ(scheduler.frames(), 300);
+    CHECK_EQ(scheduler.nextDeadline() - last, 1000000 / 30);
+}
+
+// 截止时间已过时从当前时间重新开始
+TEST(scheduler_rate_change_restarts_late_deadline) {
+    FrameScheduler scheduler;
+    scheduler.setRate(60);
+    uint32_t now = micros();
+    CHECK((int32_t) (scheduler.nextDeadline() - now) <= 0);
+    scheduler.setRate(30);
+    CHECK((int32_t) (scheduler.nextDeadline() - now) >= 0);
+    CHECK(scheduler.due(micros()));
+}
+
+TEST(scheduler_drops_missed_frames) {
+    FrameScheduler scheduler;
+    scheduler.setRate(100);
+    uint32_t start = scheduler.nextDeadline();
+    scheduler.next(start + 35000); // 晚了三帧半
+    CHECK_EQ(scheduler.nextDeadline() - start, 40000);
+    StaticJsonDocument<256> json;
+    scheduler.writeToJSON(json);
+    CHECK_EQ(json["frames"].as<int>(), 1);
+    CHECK_EQ(json["dropped"].as<int>(), 3);
+    CHECK_EQ(json["late"].as<int>(), 1);
+    CHECK_EQ(json["jitterMax"].as<int>(), 35000);
+}
+
+TEST(scheduler_defers_services_a_bounded_number_of_frames) {
+    FrameScheduler scheduler;
+    scheduler.setRate(100);
+    uint32_t deadline = scheduler.nextDeadline();
+    scheduler.next(deadline);
+    deadline = scheduler.nextDeadline();
+    uint32_t lastRun = scheduler.frames();
+    // 距离下一帧 2 ms, 只有预计耗时更短的服务执行
+    CHECK(!scheduler.defer(deadline - 2000, 1000, lastRun, 8));
+    CHECK(scheduler.defer(deadline - 2000, 5000, lastRun, 8));
+    // 连续推迟到上限后不再推迟
+    for (int i = 0; i < 7; i++) {
+        scheduler.next(deadline);
+        deadline = scheduler.nextDeadline();
+        CHECK(scheduler.defer(deadline - 2000, 5000, lastRun, 8));
+    }
+    scheduler.next(deadline);
+    deadline = scheduler.nextDeadline();
+    CHECK(!scheduler.defer(deadline - 2000, 5000, lastRun, 8));
+}
+
+TEST(trace_reports_times_relative_to_deadline) {
+    FrameTrace<4> trace;
+    for (uint32_t i = 0; i < 6; i++) {
+        uint32_t deadline = 1000000 * i;
+        trace.render(deadline - 3000, deadline - 1000);
+        trace.show(deadline, deadline + 10, deadline + 900 + i);
+    }
+    StaticJsonDocument<1024> json;
+    JsonArray array = json.createNestedArray("trace");
+    trace.writeToJSON(array);
+    CHECK_EQ(array.size(), 4);
+    for (int i = 0; i < 4; i++) { // 最旧的在前, 只保留最近 4 帧
+        CHECK_EQ(array[i]["renderStart"].as<int>(), -3000);
+        CHECK_EQ(array[i]["renderEnd"].as<int>(), -1000);
+        CHECK_EQ(array[i]["showStart"].as<int>(), 10);
+        CHECK_EQ(array[i]["showEnd"].as<int>(), 902 + i);
+    }
+}
+
+// swap 之前输出缓冲不变, 之后后台缓冲仍保留上一帧供增量绘制
+TEST(double_buffer_publishes_on_swap) {
+    DoubleBuffer<Strip> light;
+    fill_solid(light.data(), light.count(), CRGB(0x102030));
+    light.swap();
+    CHECK(light.front() != light.data());
+    fill_solid(light.data(), light.count(), CRGB(0x405060));
+    CHECK(light.front()[0] == CRGB(0x102030));
+    light.swap();
+    CHECK(light.front()[29] == CRGB(0x405060));
+    light.data()[3] = CRGB(0x000001);
+    CHECK(light.data()[0] == CRGB(0x405060));
+    CHECK(light.front()[3] == CRGB(0x405060));
+    CHECK_EQ(sizeof(light), 2 * sizeof(Strip));
+}
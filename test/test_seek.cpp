@@ -0,0 +1,104 @@
+#include "test.h"
+
+#include <vector>
+
+#include "LightEffect.hpp"
+
+typedef LightStrip<256, false> Strip;
+
+static const char *const VARIANTS[] = {"panel.anim", "panel_rle.anim", "panel_palette.anim", "panel_intra.anim"};
+
+// 未压缩动画的所有帧, 作为期望值
+static const std::vector<CRGB> &raw_frames() {
+    static std::vector<CRGB> frames;
+    if (frames.empty()) {
+        File file = LittleFS.open("/animations/panel.anim", "r");
+        AnimHeader header;
+        read_anim_header(file, header);
+        frames.resize(header.frameCount * header.ledCount);
+        file.read((uint8_t *) frames.data(), frames.size() * sizeof(CRGB));
+    }
+    return frames;
+}
+
+// 播放顺序的模型, 与 AnimPlayer 的约定相同
+struct PlayModel {
+    uint32_t frame = 0, start = 0, end = 0;
+    bool reverse = false;
+
+    uint32_t play() {
+        uint32_t last = end > 0 && end <= 1000 ? end : 1000;
+        uint32_t first = start < last ? start : 0;
+        uint32_t shown = frame >= first && frame < last ? frame : reverse ? last - 1 : first;
+        frame = reverse ? (shown == first ? last - 1 : shown - 1) : (shown + 1 == last ? first : shown + 1);
+        return shown;
+    }
+};
+
+static bool shows(Strip &light, uint32_t frame) {
+    return memcmp(light.data(), raw_frames().data() + frame * 256, sizeof(CRGB) * 256) == 0;
+}
+
+// 随机跳转, 设置循环范围和倒放, 每帧都与未压缩的对应帧相同
+TEST(seek_random_operations_match_raw) {
+    static Strip light;
+    for (const char *name : VARIANTS) {
+        AnimationEffect effect(name);
+        PlayModel model;
+        srand(1);
+        for (int i = 0; i < 3000; i++) {
+            char value[16];
+            switch (rand() % 16) {
+                case 0:
+                    model.frame = rand() % 1000;
+                    snprintf(value, sizeof(value), "%u", model.frame);
+                    CHECK(effect.set("frame", value));
+                    break;
+                case 1:
+                    model.start = rand() % 1000;
+                    snprintf(value, sizeof(value), "%u", model.start);
+                    CHECK(effect.set("loopStart", value));
+                    break;
+                case 2:
+                    model.end = rand() % 3 == 0 ? 0 : rand() % 1100;
+                    snprintf(value, sizeof(value), "%u", model.end);
+                    CHECK(effect.set("loopEnd", value));
+                    break;
+                case 3:
+                    model.reverse = !model.reverse;
+                    CHECK(effect.set("reverse", model.reverse ? "1" : "0"));
+                    break;
+            }
+            CHECK(effect.update(light, 16666));
+            CHECK(shows(light, model.play()));
+        }
+        CHECK(!effect.set("frame", "1000"));
+    }
+}
+
+// 保存的播放位置在重新创建灯效后继续播放
+TEST(seek_resumes_from_saved_frame) {
+    static Strip light;
+    for (const char *name : VARIANTS) {
+        StaticJsonDocument<256> json;
+        {
+            AnimationEffect effect(name);
+            CHECK(effect.seekable());
+            CHECK(effect.set("loopStart", "100"));
+            CHECK(effect.set("loopEnd", "700"));
+            CHECK(effect.set("reverse", "1"));
+            for (int i = 0; i < 250; i++) {
+                effect.update(light, 16666);
+            }
+            effect.writeToJSON(json);
+        }
+        CHECK_EQ(json["frame"].as<int>(), 449);
+        AnimationEffect resumed = AnimationEffect::readFromJSON(json);
+        CHECK(resumed.update(light, 16666));
+        CHECK(shows(light, 449));
+        CHECK(resumed.update(light, 16666));
+        CHECK(shows(light, 448));
+    }
+    AnimationEffect csv("panel.csv");
+    CHECK(!csv.seekable());
+}
@@ -0,0 +1,52 @@
+#include "test.h"
+
+#include "LightCompositor.hpp"
+
+typedef LightStrip<30, false> Strip;
+
+TEST(segments_reject_invalid_ranges) {
+    Strip light;
+    Segments<Strip, 4> segments;
+    CHECK(!segments.set(light, 0, "a", -1, 5, ConstantEffect(0xFF0000)));
+    CHECK(!segments.set(light, 0, "a", 28, 5, ConstantEffect(0xFF0000)));
+    CHECK(!segments.set(light, 0, "a", 0, 0, ConstantEffect(0xFF0000)));
+    CHECK(!segments.active());
+    CHECK(segments.set(light, 0, "a", 0, 10, ConstantEffect(0xFF0000)));
+    CHECK(!segments.set(light, 1, "b", 9, 5, ConstantEffect(0x00FF00)));
+    CHECK(segments.set(light, 1, "b", 10, 5, ConstantEffect(0x00FF00)));
+}
+
+TEST(segments_overlay_ranges_with_brightness) {
+    Strip light;
+    Segments<Strip, 4> segments;
+    CRGB out[30];
+    fill_solid(out, 30, CRGB(0x000010));
+    CHECK(segments.set(light, 0, "a", 2, 3, ConstantEffect(0xFF0000)));
+    CHECK(segments.set(light, 1, "b", 20, 2, ConstantEffect(0x00FF00)));
+    segments.setBrightness(1, 127);
+    CHECK(segments.update(16666));
+    segments.overlay(light, out);
+    CHECK(out[1] == CRGB(0x000010));
+    CHECK(out[2] == CRGB(0xFF0000));
+    CHECK(out[4] == CRGB(0xFF0000));
+    CHECK(out[5] == CRGB(0x000010));
+    CHECK(out[20] == CRGB(0x007F00));
+    CHECK(!segments.update(16666));
+}
+
+// 没有分段时不占用帧内存
+TEST(segments_allocate_scratch_on_demand) {
+    Strip light;
+    Segments<Strip, 4> segments;
+    typedef LightPanel<16, 16, Z_WORD | HORIZONTAL> Panel;
+    CHECK(sizeof(Segments<Panel, 4>) < sizeof(Panel));
+    uint64_t live = test_live_allocations();
+    CHECK(segments.set(light, 0, "a", 0, 10, ConstantEffect(0xFF0000)));
+    CHECK(segments.set(light, 1, "b", 10, 10, ConstantEffect(0xFF0000)));
+    CHECK_EQ(test_live_allocations() - live, 1);
+    CHECK(segments.clear(0));
+    CHECK_EQ(test_live_allocations() - live, 1);
+    CHECK(segments.clear(1));
+    CHECK(!segments.clear(1));
+    CHECK_EQ(test_live_allocations(), live);
+}
@@ -0,0 +1,121 @@
+#include "test.h"
+
+#include "LightEffect.hpp"
+#include "LightLayout.hpp"
+
+// 把坐标写入颜色, 便于检查每个灯珠收到的坐标
+static CRGB encode(LightPoint p) {
+    return CRGB(p.x, p.y, p.z);
+}
+
+TEST(shader_strip_coordinates) {
+    LightStrip<30, true> strip;
+    strip.shadePixels(encode);
+    CHECK(strip.at(0) == CRGB(0, 0, 0));
+    CHECK(strip.at(29) == CRGB(255, 0, 0));
+    for (int i = 0; i < 30; i++) {
+        CHECK_EQ(strip.at(i).r, i * 255 / 29);
+    }
+}
+
+TEST(shader_panel_coordinates) {
+    LightPanel<16, 8, SNAKE | VERTICAL | MIRROR> panel;
+    panel.shadePixels(encode);
+    for (int y = 0; y < 8; y++) {
+        for (int x = 0; x < 16; x++) {
+            CHECK(panel.at(x, y) == CRGB(x * 255 / 15, y * 255 / 7, 0));
+        }
+    }
+}
+
+TEST(shader_disc_coordinates) {
+    typedef LightDisc<ANTICLOCKWISE | INSIDE_OUT, 12, 6, 3> Disc;
+    Disc disc;
+    disc.shadePixels(encode);
+    for (int i = 0; i < Disc::count(); i++) {
+        CHECK(disc.data()[i] == CRGB(Disc::angle(i), Disc::radius(i), 0));
+    }
+    // 顺时针方向角度递增, 最大的环半径为 255
+    for (int i = 0; i < 12; i++) {
+        CHECK(disc.at(0, i) == CRGB(i * 256 / 12, 255, 0));
+    }
+    CHECK(disc.at(2, 1) == CRGB(256 / 3, 3 * 255 / 12, 0));
+}
+
+TEST(shader_cube_coordinates) {
+    LightCube<4, 5, 6> cube;
+    cube.shadePixels(encode);
+    for (int z = 0; z < 6; z++) {
+        for (int y = 0; y < 5; y++) {
+            for (int x = 0; x < 4; x++) {
+                CHECK(cube.at(x, y, z) == CRGB(x * 255 / 3, y * 255 / 4, z * 255 / 5));
+            }
+        }
+    }
+}
+
+TEST(shader_segment_coordinates) {
+    CRGB leds[100];
+    for (int n = 1; n <= 100; n++) {
+        LightSegment segment(leds, n);
+        segment.shadePixels(encode);
+        for (int i = 0; i < n; i++) {
+            CHECK_EQ(leds[i].r, n > 1 ? i * 255 / (n - 1) : 0);
+        }
+    }
+}
+
+// 运行时形态与对应的固定形态得到相同的坐标
+template <typename Fixed>
+static bool layout_matches(JsonDocument &json) {
+    typedef LightLayout<512> Layout;
+    if (!Layout::readFromJSON(json)) {
+        return false;
+    }
+    static Layout layout;
+    static Fixed fixed;
+    if (layout.count() != fixed.count()) {
+        return false;
+    }
+    layout.shadePixels(encode);
+    fixed.shadePixels(encode);
+    return memcmp(layout.data(), fixed.data(), fixed.count() * sizeof(CRGB)) == 0;
+}
+
+TEST(shader_layout_matches_fixed_lights) {
+    StaticJsonDocument<256> json;
+    json["type"] = "strip";
+    json["count"] = 30;
+    json["reverse"] = true;
+    CHECK((layout_matches<LightStrip<30, true>>(json)));
+
+    json.clear();
+    json["type"] = "panel";
+    json["width"] = 16;
+    json["height"] = 8;
+    json["arrangement"] = SNAKE | VERTICAL | FLIP;
+    CHECK((layout_matches<LightPanel<16, 8, SNAKE | VERTICAL | FLIP>>(json)));
+
+    json.clear();
+    json["type"] = "disc";
+    json["arrangement"] = ANTICLOCKWISE | INSIDE_OUT;
+    JsonArray rings = json.createNestedArray("rings");
+    rings.add(12);
+    rings.add(6);
+    rings.add(3);
+    CHECK((layout_matches<LightDisc<ANTICLOCKWISE | INSIDE_OUT, 12, 6, 3>>(json)));
+}
+
+// 流光的三种方向在任意形态上都能编译, 分别按行, 沿 x 轴和沿对角线渐变
+TEST(shader_stream_directions) {
+    LightPanel<8, 8, SNAKE> panel;
+    LightCube<4, 4, 4> cube;
+    for (int direction = 0; direction < 3; direction++) {
+        StreamEffect panelStream(direction, 1), cubeStream(direction, 1);
+        CHECK(panelStream.update(panel, 0));
+        CHECK(cubeStream.update(cube, 0));
+        CHECK((panel.at(0, 0) != panel.at(7, 0)) == (direction != 0));
+        CHECK((panel.at(0, 0) != panel.at(0, 7)) == (direction != 1));
+        CHECK((cube.at(0, 0, 0) != cube.at(0, 3, 3)) == (direction != 1));
+    }
+}
@@ -0,0 +1,95 @@
+#include "test.h"
+
+#include "LightEffect.hpp"
+
+typedef LightStrip<30, false> Strip;
+
+// 以给定帧率渲染 2.5 秒, 每帧的时间戳取整到微秒, 与实际时钟相同
+static void render(Effect<Strip> &effect, Strip &light, int fps) {
+    const uint32_t DURATION = 2500000;
+    uint32_t last = 0;
+    for (int i = 1; (uint64_t) i * 1000000 / fps <= DURATION; i++) {
+        uint32_t now = (uint64_t) i * 1000000 / fps;
+        effect.update(light, now - last);
+        last = now;
+    }
+}
+
+// 灯效按时间而非帧数前进, 不同帧率下相同时刻的画面必须一致
+TEST(effects_match_across_frame_rates) {
+    const char *args[][3] = {
+        {"#FF0000", "0.3", "0.2"},
+        {"#00FF00", "0.7", "0.4"},
+        {"#0000FF", "0", "0.1"},
+        {"#FFFFFF", "1", "0.25"},
+        {"7"},
+        {"0", "3"},
+        {"1", "-2"},
+    };
+    const EffectType types[] = {BLINK, BREATH, CHASE, CHASE, RAINBOW, STREAM, STREAM};
+    const int rates[] = {30, 60, 120};
+    for (size_t t = 0; t < ARRAY_LENGTH(types); t++) {
+        Strip frames[ARRAY_LENGTH(rates)];
+        for (size_t r = 0; r < ARRAY_LENGTH(rates); r++) {
+            Effect<Strip> effect = Effect<Strip>::create(types[t], 3, args[t]);
+            fill_solid(frames[r].data(), frames[r].count(), CRGB::Black);
+            render(effect, frames[r], rates[r]);
+        }
+        for (size_t r = 1; r < ARRAY_LENGTH(rates); r++) {
+            for (int i = 0; i < frames[0].count(); i++) {
+                if (frames[r].data()[i] != frames[0].data()[i]) {
+                    printf("  %s at %d fps differs at LED %d\n", (const char *) effect2str(types[t]), rates[r], i);
+                }
+                CHECK(frames[r].data()[i] == frames[0].data()[i]);
+            }
+        }
+    }
+}
+
+// 非正数, 过大和无法解析的时长被拒绝, 命令参数和配置中的无效时长使用默认值
+TEST(effect_durations_are_validated) {
+    const char *args[] = {"#FF0000", "-1", "nan"};
+    BlinkEffect blink = BlinkEffect::fromArgs(3, args);
+    StaticJsonDocument<256> json;
+    blink.writeToJSON(json);
+    CHECK(json["lastTime"].as<float>() == 1.0f);
+    CHECK(json["interval"].as<float>() == 1.0f);
+
+    CHECK(!blink.set("lastTime", "0"));
+    CHECK(!blink.set("lastTime", "1e9"));
+    CHECK(!blink.set("interval", "-0.5"));
+    CHECK(blink.set("interval", "0"));
+
+    BreathEffect breath = BreathEffect::fromArgs(3, args);
+    CHECK(!breath.set("lastTime", "inf"));
+    CHECK(breath.set("lastTime", "1800"));
+
+    ChaseEffect chase = ChaseEffect::fromArgs(3, args);
+    CHECK(!chase.set("lastTime", "-0.2"));
+    CHECK(!chase.set("lastTime", "x"));
+
+    StaticJsonDocument<256> saved;
+    saved["color"] = 0xFF0000;
+    saved["lastTime"] = -3;
+    saved["interval"] = 1e12;
+    BreathEffect restored = BreathEffect::readFromJSON(saved);
+    json.clear();
+    restored.writeToJSON(json);
+    CHECK(json["lastTime"].as<float>() == 1.0f);
+    CHECK(json["interval"].as<float>() == 0.5f);
+}
+
+// 往返一次超过 2^32 us 时仍按步前进, 不因乘积溢出而跳变
+TEST(chase_long_steps_do_not_wrap) {
+    const char *args[] = {"#FF0000", "0", "1800"};
+    ChaseEffect chase = ChaseEffect::fromArgs(3, args);
+    Strip light;
+    for (int step = 0; step < 35; step++) {
+        chase.update(light, step == 0 ? 0 : 1800000000);
+    }
+    chase.update(light, 1800000000 - 1);
+    // 第 34 步往回走到第 25 个灯珠, 时间尚未到第 35 步
+    for (int i = 0; i < light.count(); i++) {
+        CHECK(light.data()[i] == (i == 25 ? CRGB(0xFF0000) : CRGB(CRGB::Black)));
+    }
+}
@@ -0,0 +1,88 @@
+#include "test.h"
+
+#include <string>
+
+#include "Animation.hpp"
+
+static std::string read_file(const char *path) {
+    std::string data;
+    File file = LittleFS.open(path, "r");
+    uint8_t buffer[256];
+    size_t n;
+    while (file && (n = file.read(buffer, sizeof(buffer))) > 0) {
+        data.append((const char *) buffer, n);
+    }
+    return data;
+}
+
+// 按 chunk 字节分块转换, 模拟 HTTP 上传
+static bool transcode(const std::string &csv, uint16_t ledCount, size_t chunk, AnimTranscoder &transcoder) {
+    if (!transcoder.begin(LittleFS.open("/transcoded.anim", "w"), ledCount, 0)) {
+        return false;
+    }
+    for (size_t i = 0; i < csv.size(); i += chunk) {
+        if (!transcoder.write((const uint8_t *) csv.data() + i, std::min(chunk, csv.size() - i))) {
+            transcoder.abort();
+            return false;
+        }
+    }
+    return transcoder.end();
+}
+
+// 与 pack_anim.py 生成的未压缩动画逐字节相同, 与分块大小无关
+TEST(transcoder_matches_pack_anim) {
+    const size_t chunks[] = {1, 7, 48, 1460, 1 << 20};
+    std::string csv = read_file("/animations/example.csv"), anim = read_file("/animations/example.anim");
+    for (size_t chunk : chunks) {
+        AnimTranscoder transcoder;
+        CHECK(transcode(csv, 21, chunk, transcoder));
+        CHECK_EQ(transcoder.frames(), 31);
+        CHECK(read_file("/transcoded.anim") == anim);
+    }
+}
+
+// 内存占用与文件大小无关, 转换过程不分配内存
+TEST(transcoder_does_not_allocate) {
+    std::string csv = read_file("/animations/panel.csv");
+    AnimTranscoder transcoder;
+    CHECK(transcoder.begin(LittleFS.open("/transcoded.anim", "w"), 256, 0));
+    uint64_t allocations = test_allocations();
+    for (size_t i = 0; i < csv.size(); i += 1460) {
+        CHECK(transcoder.write((const uint8_t *) csv.data() + i, std::min<size_t>(1460, csv.size() - i)));
+    }
+    CHECK(transcoder.end());
+    CHECK_EQ(test_allocations(), allocations);
+    CHECK(read_file("/transcoded.anim") == read_file("/animations/panel.anim"));
+}
+
+TEST(transcoder_accepts_crlf_and_blank_lines) {
+    AnimTranscoder transcoder;
+    CHECK(transcode("#010203, #040506\r\n\r\n#070809,#0A0B0C", 2, 5, transcoder));
+    std::string anim = read_file("/transcoded.anim");
+    CHECK_EQ(anim.size(), sizeof(AnimHeader) + 12);
+    CHECK_EQ((uint8_t) anim[sizeof(AnimHeader)], 0x01);
+    CHECK_EQ((uint8_t) anim.back(), 0x0C);
+}
+
+// 出错时报告行号
+TEST(transcoder_reports_malformed_rows) {
+    AnimTranscoder transcoder;
+    CHECK(!transcode("#000000,#000000\n#000000\n", 2, 64, transcoder));
+    CHECK(strcmp(transcoder.error(), "Line 2: 1 LEDs, expected 2") == 0);
+    CHECK(!transcode("#000000,#000000\n\n#000000,#000000,#000000\n", 2, 64, transcoder));
+    CHECK(strcmp(transcoder.error(), "Line 3: more than 2 LEDs") == 0);
+    CHECK(!transcode("#000000,#00000G\n", 2, 64, transcoder));
+    CHECK(strcmp(transcoder.error(), "Line 1: invalid element \"#00000G\"") == 0);
+    CHECK(!transcode("#000000,#0000000000\n", 2, 3, transcoder));
+    CHECK(strcmp(transcoder.error(), "Line 1: invalid element \"#000000...\"") == 0);
+    CHECK(!transcode("\n\n", 2, 64, transcoder));
+    CHECK(strcmp(transcoder.error(), "No frames") == 0);
+    CHECK_EQ(File::opened(), 0);
+}
+
+TEST(transcoder_reports_open_failure) {
+    AnimTranscoder transcoder;
+    CHECK(!transcoder.begin(LittleFS.open("/missing/dir.anim", "w"), 2, 0));
+    CHECK(transcoder.failed());
+    CHECK(!transcoder.write((const uint8_t *) "#000000", 7));
+}
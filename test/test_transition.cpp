@@ -0,0 +1,39 @@
+#include "test.h"
+
+#include "LightCompositor.hpp"
+
+typedef LightStrip<30, false> Strip;
+
+TEST(transition_crossfades_and_frees_frames) {
+    Strip out;
+    Transition<Strip> transition;
+    Effect<Strip> current = ConstantEffect(0x000000);
+    transition.update(current, out, 0);
+    uint64_t live = test_live_allocations();
+
+    transition.start(current, ConstantEffect(0xFEFEFE), out, 100);
+    CHECK(transition.active());
+    CHECK_EQ(current.type(), CONSTANT);
+    CHECK(&transition.target(out) != &out);
+    CHECK(transition.update(current, out, 50000));
+    CHECK(out.data()[0] == CRGB(0x7F7F7F));
+    CHECK(transition.update(current, out, 50000));
+    CHECK(out.data()[0] == CRGB(0xFEFEFE));
+
+    CHECK(!transition.active());
+    CHECK(&transition.target(out) == &out);
+    CHECK_EQ(test_live_allocations(), live);
+}
+
+TEST(transition_without_duration_switches_instantly) {
+    Strip out;
+    Transition<Strip> transition;
+    Effect<Strip> current = ConstantEffect(0x000000);
+    uint64_t allocations = test_allocations();
+    transition.start(current, ConstantEffect(0x123456), out, 0);
+    CHECK(!transition.active());
+    CHECK(transition.update(current, out, 16666));
+    CHECK(out.data()[0] == CRGB(0x123456));
+    CHECK_EQ(test_allocations(), allocations);
+    CHECK(sizeof(Transition<LightPanel<16, 16, Z_WORD | HORIZONTAL>>) < sizeof(LightPanel<16, 16, Z_WORD | HORIZONTAL>));
+}
@@ -0,0 +1,59 @@
+#include "test.h"
+
+#include "Waveform.hpp"
+
+TEST(waveform_square_follows_timing) {
+    Waveform wave(WAVE_SQUARE, 300000, 200000);
+    CHECK_EQ(wave.level(), 255);
+    CHECK_EQ(wave.advance(299999), 255);
+    CHECK_EQ(wave.advance(1), 0);
+    CHECK_EQ(wave.advance(199999), 0);
+    CHECK_EQ(wave.advance(1), 255);
+    CHECK_EQ(wave.advance(5 * 500000 + 300000), 0); // 跨越多个周期
+}
+
+// 抛物线与原 BreathEffect 的 -1010x^2 + 1010x 一致 (原公式峰值为 252)
+TEST(waveform_parabola_matches_old_breath) {
+    Waveform wave(WAVE_PARABOLA, 1000000, 0);
+    for (int t = 0; t < 1000000; t += 997) {
+        double x = t / 1000000.0;
+        int expected = std::min(1020 * x * (1 - x), 255.0);
+        int level = wave.level();
+        CHECK(abs(level - expected) <= 2);
+        wave.advance(997);
+    }
+}
+
+TEST(waveform_shapes_are_symmetric) {
+    const WaveShape shapes[] = {WAVE_TRIANGLE, WAVE_PARABOLA, WAVE_SINE, WAVE_EASE};
+    for (WaveShape shape : shapes) {
+        Waveform rising(shape, 256000, 0), falling(shape, 256000, 0);
+        CHECK(rising.level() <= 2);
+        rising.advance(1500); // 取每一项的中点, 避开相位取整
+        falling.advance(254500);
+        for (int i = 1; i < 127; i++) {
+            CHECK(abs(rising.level() - falling.level()) <= 4); // sin8 的折线近似不完全对称
+            uint8_t before = rising.level();
+            rising.advance(1000);
+            falling.advance(256000 - 1000);
+            CHECK(rising.level() >= before);
+        }
+    }
+}
+
+static const uint8_t RAMP[256] PROGMEM = {
+#define R4(i) (i), (i) + 1, (i) + 2, (i) + 3
+#define R16(i) R4(i), R4((i) + 4), R4((i) + 8), R4((i) + 12)
+#define R64(i) R16(i), R16((i) + 16), R16((i) + 32), R16((i) + 48)
+    R64(0), R64(64), R64(128), R64(192)
+};
+
+TEST(waveform_custom_curve) {
+    Waveform wave(WAVE_CUSTOM, 256000, 1000, RAMP);
+    wave.advance(500); // 取每一项的中点, 避开相位取整
+    for (int i = 0; i < 256; i++) {
+        CHECK_EQ(wave.level(), i);
+        wave.advance(1000);
+    }
+    CHECK_EQ(wave.level(), 0);
+}
@@ -1,13 +1,31 @@
 #include "utils.h"
 
 #include "LightEffect.hpp"
+#include "LightCompositor.hpp"
+#include "LightLayout.hpp"
 
-const char* EFFECT_TYPE_MAP[] = {
-    "constant", "blink", "breath", "chase", "rainbow", "stream",
-    "animation", "music", "custom"
+const char* BLEND_MODE_MAP[] = {
+    "add", "alpha", "max", "multiply", "mask"
 };
-static_assert(ARRAY_LENGTH(EFFECT_TYPE_MAP) == EFFECT_TYPE_COUNT,
-                "EFFECT_TYPE_MAP size mismatch!");
+static_assert(ARRAY_LENGTH(BLEND_MODE_MAP) == BLEND_MODE_COUNT,
+                "BLEND_MODE_MAP size mismatch!");
+
+const char* LAYOUT_TYPE_MAP[] = {
+    "strip", "panel", "disc"
+};
+static_assert(ARRAY_LENGTH(LAYOUT_TYPE_MAP) == LAYOUT_TYPE_COUNT,
+                "LAYOUT_TYPE_MAP size mismatch!");
+
+#ifdef ENABLE_PROFILER
+Profiler profiler;
+#endif
+
+uint32_t EffectCounters::created = 0;
+uint32_t EffectCounters::destroyed = 0;
+uint16_t EffectCounters::openFiles = 0;
+
+AnimPlayer *AnimPlayer::first = nullptr;
+uint32_t AnimPlayer::underruns = 0;
 
 uint32_t rgb2hex(uint8_t r, uint8_t g, uint8_t b) {   
     return ((r & 0xff) << 16) + ((g & 0xff) << 8) + (b & 0xff);
@@ -19,6 +37,61 @@ uint32_t str2hex(const char *str) {
     return (uint32_t) strtol(str + 1, NULL, 16);
 }
 
+static bool parse_long(const char *str, long min, long max, long &value) {
+    char *end;
+    long result = strtol(str, &end, 10);
+    if (end == str || *end != '\0' || result < min || result > max)
+        return false;
+    value = result;
+    return true;
+}
+
+bool parse_param(const char *str, float &value) {
+    char *end;
+    float result = strtof(str, &end);
+    if (end == str || *end != '\0')
+        return false;
+    value = result;
+    return true;
+}
+
+bool parse_param(const char *str, int8_t &value) {
+    long result;
+    if (!parse_long(str, INT8_MIN, INT8_MAX, result))
+        return false;
+    value = result;
+    return true;
+}
+
+bool parse_param(const char *str, uint8_t &value) {
+    long result;
+    if (!parse_long(str, 0, UINT8_MAX, result))
+        return false;
+    value = result;
+    return true;
+}
+
+bool parse_param(const char *str, uint32_t &value) {
+    long result;
+    if (!parse_long(str, 0, INT32_MAX, result))
+        return false;
+    value = result;
+    return true;
+}
+
+bool parse_param(const char *str, bool &value) {
+    long result;
+    if (!parse_long(str, 0, 1, result))
+        return false;
+    value = result;
+    return true;
+}
+
+bool parse_param(const char *str, String &value) {
+    value = str;
+    return true;
+}
+
 void hex2str(uint32_t hex, char *str) {
     sprintf(str, "#%06x", hex);
 }
@@ -59,16 +132,47 @@ uint32_t kelvin2rgb(uint32_t t) {
 }
 
 EffectType str2effect(const char *str) {
-    for (int i = 0; i < EFFECT_TYPE_COUNT; i++) {
-        if (strcmp(str, EFFECT_TYPE_MAP[i]) == 0) {
-            return (EffectType) i;
+    return Effects::find(str);
+}
+
+const __FlashStringHelper* effect2str(EffectType effect) {
+    if (effect >= EFFECT_TYPE_COUNT)
+        return F("");
+    return FPSTR(Effects::names[effect].str);
+}
+
+const __FlashStringHelper* effect2args(EffectType effect) {
+    if (effect >= EFFECT_TYPE_COUNT)
+        return F("");
+    return FPSTR(Effects::args[effect].str);
+}
+
+BlendMode str2blend(const char *str) {
+    for (int i = 0; i < BLEND_MODE_COUNT; i++) {
+        if (strcmp(str, BLEND_MODE_MAP[i]) == 0) {
+            return (BlendMode) i;
         }
     }
-    return EFFECT_TYPE_COUNT;
+    return BLEND_MODE_COUNT;
 }
 
-const char* effect2str(EffectType effect) {
-    if (effect >= EFFECT_TYPE_COUNT)
+const char* blend2str(BlendMode mode) {
+    if (mode >= BLEND_MODE_COUNT)
+        return "";
+    return BLEND_MODE_MAP[mode];
+}
+
+LayoutType str2layout(const char *str) {
+    for (int i = 0; i < LAYOUT_TYPE_COUNT; i++) {
+        if (strcmp(str, LAYOUT_TYPE_MAP[i]) == 0) {
+            return (LayoutType) i;
+        }
+    }
+    return LAYOUT_TYPE_COUNT;
+}
+
+const char* layout2str(LayoutType type) {
+    if (type >= LAYOUT_TYPE_COUNT)
         return "";
-    return EFFECT_TYPE_MAP[effect];
+    return LAYOUT_TYPE_MAP[type];
 }
@@ -44,6 +44,20 @@ void hex2str(uint32_t hex, char *str);
  */
 uint32_t kelvin2rgb(uint32_t t);
 
+/**
+ * @brief Parse a parameter value, leaving the value untouched on failure
+ *
+ * @param str string to parse
+ * @param value parsed value
+ * @return bool whether the whole string is a valid value in range
+ */
+bool parse_param(const char *str, float &value);
+bool parse_param(const char *str, int8_t &value);
+bool parse_param(const char *str, uint8_t &value);
+bool parse_param(const char *str, uint32_t &value);
+bool parse_param(const char *str, bool &value);
+bool parse_param(const char *str, String &value);
+
 // The compiler of ESP8266 does not support C++20...
 // Older compiler even does not support C++14
 template <typename T>
@@ -51,4 +65,44 @@ constexpr T sum(T *begin, T *end, typename std::decay<T>::type init) {
     return begin == end ? init : sum(begin + 1, end, init + *begin);
 }
 
+constexpr size_t str_length(const char *str) {
+    return *str ? 1 + str_length(str + 1) : 0;
+}
+
+template <size_t... I>
+struct index_seq {};
+
+template <typename A, typename B>
+struct concat_index_seq;
+
+template <size_t... I, size_t... J>
+struct concat_index_seq<index_seq<I...>, index_seq<J...>> {
+    typedef index_seq<I..., (sizeof...(I) + J)...> type;
+};
+
+// 二分生成 0..N-1, 模板递归深度为 log(N), 可用于上千个灯珠
+template <size_t N>
+struct make_index_seq : concat_index_seq<typename make_index_seq<N / 2>::type,
+                                         typename make_index_seq<N - N / 2>::type> {};
+
+template <>
+struct make_index_seq<0> {
+    typedef index_seq<> type;
+};
+
+template <>
+struct make_index_seq<1> {
+    typedef index_seq<0> type;
+};
+
+template <typename T>
+constexpr T max_of(T value) {
+    return value;
+}
+
+template <typename T, typename... Ts>
+constexpr T max_of(T a, T b, Ts... rest) {
+    return max_of(a > b ? a : b, rest...);
+}
+
 #endif // __UTIL_H__